@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    AudioProfiler.cpp
+    Created: 18 Oct 2026 2:20:51am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "AudioProfiler.h"
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+namespace
+{
+   #if JUCE_INTEL
+    // the time stamp counter runs at a fixed rate on anything recent, measure it once against the os clock
+    double calibrateTicksPerSecond()
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        const auto startCycles = (juce::int64)__rdtsc();
+
+        // ~5ms is plenty, the error is well under a percent
+        while (juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) < 0.005) {}
+
+        const double seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+        return (double)((juce::int64)__rdtsc() - startCycles) / seconds;
+    }
+   #else
+    double calibrateTicksPerSecond()
+    {
+        return (double)juce::Time::getHighResolutionTicksPerSecond();
+    }
+   #endif
+
+    // 0 until calibrate() has run
+    std::atomic<double> ticksPerSecond{ 0.0 };
+}
+
+void AudioProfiler::calibrate()
+{
+    // measured by the first caller only, later ones return straight away
+    static const double measured = calibrateTicksPerSecond();
+    ticksPerSecond.store(measured, std::memory_order_relaxed);
+}
+
+juce::int64 AudioProfiler::now()
+{
+   #if JUCE_INTEL
+    return (juce::int64)__rdtsc();
+   #else
+    return juce::Time::getHighResolutionTicks();
+   #endif
+}
+
+double AudioProfiler::ticksToSeconds(juce::int64 ticks)
+{
+    const double rate = ticksPerSecond.load(std::memory_order_relaxed);
+    return rate > 0.0 ? (double)ticks / rate : 0.0;
+}
+
+juce::String AudioProfiler::getStageName(int stage)
+{
+    switch (stage)
+    {
+        case callbackStage: return "callback";
+        case mixerStage:    return "mixer";
+        case padsStage:     return "pads";
+        case spectrumStage: return "spectrum";
+        default: break;
+    }
+
+    static const char* const deckStageNames[] = { "resample", "keylock", "chorus", "delay", "reverb", "compressor" };
+    static_assert(juce::numElementsInArray(deckStageNames) == stagesPerDeck, "one name per deck stage");
+
+    const int deck = (stage - firstDeckStage) / stagesPerDeck;
+    return "deck " + juce::String(deck + 1) + " " + deckStageNames[(stage - firstDeckStage) % stagesPerDeck];
+}
+
+void AudioProfiler::prepare(double rate)
+{
+    // before audio starts, so the audio thread never pays for it
+    calibrate();
+    sampleRate.store(rate, std::memory_order_relaxed);
+}
+
+void AudioProfiler::record(int stage, juce::int64 elapsedTicks)
+{
+    jassert(stage >= 0 && stage < numStages);
+    auto& d = stageData[(size_t)stage];
+
+    const double seconds = ticksToSeconds(juce::jmax((juce::int64)0, elapsedTicks));
+    const double ns = seconds * 1.0e9;
+    const int bin = ns > 1.0 ? juce::jmin(numBins - 1, (int)(std::log2(ns) * binsPerOctave)) : 0;
+
+    // one writer per stage, so load + store instead of locked increments
+    auto& b = d.bins[(size_t)bin];
+    b.store(b.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    d.totalSeconds.store(d.totalSeconds.load(std::memory_order_relaxed) + seconds, std::memory_order_relaxed);
+}
+
+void AudioProfiler::recordCallback(juce::int64 elapsedTicks, int numSamples)
+{
+    record(callbackStage, elapsedTicks);
+
+    // longer than the audio it produced, the device would have run dry without its own buffering
+    const double rate = sampleRate.load(std::memory_order_relaxed);
+    if (rate > 0.0 && ticksToSeconds(elapsedTicks) > numSamples / rate)
+        deadlineMisses.store(deadlineMisses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    callbacks.store(callbacks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    samples.store(samples.load(std::memory_order_relaxed) + (juce::uint64)numSamples, std::memory_order_relaxed);
+}
+
+AudioProfiler::Snapshot AudioProfiler::getSnapshot() const
+{
+    Snapshot s;
+
+    // a block landing mid copy only skews this one snapshot, the next picks it up
+    for (size_t i = 0; i < (size_t)numStages; ++i)
+    {
+        const auto& d = stageData[i];
+        s.totalSeconds[i] = d.totalSeconds.load(std::memory_order_relaxed);
+
+        for (size_t b = 0; b < (size_t)numBins; ++b)
+            s.bins[i][b] = d.bins[b].load(std::memory_order_relaxed);
+    }
+
+    s.callbacks = callbacks.load(std::memory_order_relaxed);
+    s.deadlineMisses = deadlineMisses.load(std::memory_order_relaxed);
+    s.samples = samples.load(std::memory_order_relaxed);
+    s.sampleRate = sampleRate.load(std::memory_order_relaxed);
+    return s;
+}
+
+AudioProfiler::StageStats AudioProfiler::summarise(const Snapshot& current, const Snapshot& baseline, int stage)
+{
+    StageStats stats;
+    const auto i = (size_t)stage;
+
+    // histogram of just the window since the baseline
+    std::array<juce::uint32, numBins> bins;
+    juce::uint32 count = 0;
+
+    for (size_t b = 0; b < (size_t)numBins; ++b)
+    {
+        bins[b] = current.bins[i][b] - baseline.bins[i][b];
+        count += bins[b];
+    }
+
+    if (count == 0) return stats;
+
+    stats.count = count;
+    stats.meanMicros = (current.totalSeconds[i] - baseline.totalSeconds[i]) * 1.0e6 / count;
+
+    // percentiles to the upper edge of their bin, ~19% resolution
+    const auto percentile = [&](double p)
+    {
+        const auto target = (juce::uint32)std::ceil(p * count);
+        juce::uint32 seen = 0;
+
+        for (int b = 0; b < numBins; ++b)
+        {
+            seen += bins[(size_t)b];
+            if (seen >= target) return binSeconds(b) * 1.0e6;
+        }
+
+        return binSeconds(numBins - 1) * 1.0e6;
+    };
+
+    stats.p50Micros = percentile(0.5);
+    stats.p99Micros = percentile(0.99);
+    stats.maxMicros = percentile(1.0);
+    return stats;
+}
+
+double AudioProfiler::binSeconds(int bin)
+{
+    return std::exp2((bin + 1) / (double)binsPerOctave) * 1.0e-9;
+}
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    AudioProfiler.h
+    Created: 18 Oct 2026 2:20:51am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// timing histograms for the audio callback and every stage under it
+// each stage has exactly one writer at a time (the thread rendering it), so recording
+// is a few relaxed loads and stores, no locks, no read-modify-write
+// the gui takes snapshots and works out percentiles on its own copy
+class AudioProfiler
+{
+public:
+    static constexpr int maxDecks = 8;
+
+    enum Stage { callbackStage = 0, mixerStage, padsStage, spectrumStage, firstDeckStage };
+
+    // per deck, keylock covers the resampler too while it is on
+    enum DeckStage { resampleStage = 0, keylockStage, chorusStage, delayStage, reverbStage, compressorStage, stagesPerDeck };
+
+    static constexpr int numStages = firstDeckStage + maxDecks * stagesPerDeck;
+
+    // quarter octave bins from 1ns up to ~268ms
+    static constexpr int binsPerOctave = 4;
+    static constexpr int numBins = 28 * binsPerOctave;
+
+    static int getDeckStage(int deck, int stage) { return firstDeckStage + deck * stagesPerDeck + stage; }
+    static juce::String getStageName(int stage);
+
+    // cycle counter where there is one, high resolution ticks elsewhere
+    static juce::int64 now();
+    static double ticksToSeconds(juce::int64 ticks);
+
+    // measures the tick rate the first time (a few ms), ticksToSeconds reads 0 until then
+    // prepare calls it, anything timing without a profiler calls it while preparing
+    static void calibrate();
+
+    // audio thread
+    void prepare(double sampleRate);
+    void record(int stage, juce::int64 elapsedTicks);
+
+    // the whole callback, also counts blocks that took longer than they last
+    void recordCallback(juce::int64 elapsedTicks, int numSamples);
+
+    struct Snapshot
+    {
+        std::array<std::array<juce::uint32, numBins>, numStages> bins{};
+        std::array<double, numStages> totalSeconds{};
+        juce::uint32 callbacks{ 0 };
+        juce::uint32 deadlineMisses{ 0 };
+        juce::uint64 samples{ 0 };
+        double sampleRate{ 0.0 };
+    };
+
+    struct StageStats
+    {
+        juce::uint32 count{ 0 };
+        double meanMicros{ 0.0 };
+        double p50Micros{ 0.0 };
+        double p99Micros{ 0.0 };
+        double maxMicros{ 0.0 };
+    };
+
+    // any thread, never blocks the writers
+    Snapshot getSnapshot() const;
+
+    // stats of one stage over everything recorded after baseline
+    static StageStats summarise(const Snapshot& current, const Snapshot& baseline, int stage);
+
+    // times a scope into a stage, does nothing without a profiler
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(AudioProfiler* p, int s) : profiler(p), stage(s), start(p != nullptr ? now() : 0) {}
+        ~ScopedTimer() { if (profiler != nullptr) profiler->record(stage, now() - start); }
+
+    private:
+        AudioProfiler* profiler;
+        const int stage;
+        const juce::int64 start;
+    };
+
+    // times another source as one stage, for sources that know nothing about the profiler
+    class TimedSource : public juce::AudioSource
+    {
+    public:
+        TimedSource(juce::AudioSource& s, AudioProfiler& p, int st) : source(s), profiler(p), stage(st) {}
+
+        void prepareToPlay(int samplesPerBlockExpected, double rate) override { source.prepareToPlay(samplesPerBlockExpected, rate); }
+        void releaseResources() override { source.releaseResources(); }
+
+        void getNextAudioBlock(const juce::AudioSourceChannelInfo& info) override
+        {
+            const ScopedTimer timer(&profiler, stage);
+            source.getNextAudioBlock(info);
+        }
+
+    private:
+        juce::AudioSource& source;
+        AudioProfiler& profiler;
+        const int stage;
+    };
+
+private:
+    // upper edge of a bin, in seconds
+    static double binSeconds(int bin);
+
+    struct StageData
+    {
+        std::array<std::atomic<juce::uint32>, numBins> bins{};
+        std::atomic<double> totalSeconds{ 0.0 };
+    };
+
+    std::array<StageData, numStages> stageData;
+
+    std::atomic<juce::uint32> callbacks{ 0 };
+    std::atomic<juce::uint32> deadlineMisses{ 0 };
+    std::atomic<juce::uint64> samples{ 0 };
+    std::atomic<double> sampleRate{ 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioProfiler)
+};
@@ -0,0 +1,398 @@
+/*
+  ==============================================================================
+
+    Benchmarks.cpp
+    Created: 18 Oct 2026 1:42:19am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Benchmarks.h"
+#include "DJAudioPlayer.h"
+#include "EffectsDeck.h"
+#include "SampleAudioSource.h"
+#include "SpectrumAnalyser.h"
+#include "ParallelMixer.h"
+#include "CommandLineArgs.h"
+
+namespace
+{
+    struct Config
+    {
+        int blockSize;
+        double sampleRate;
+        double seconds;
+    };
+
+    // times one component block by block
+    // beforeBlock runs untimed (refilling input, moving controls)
+    class Bench
+    {
+    public:
+        Bench(juce::Array<juce::var>& resultsToAddTo) : results(resultsToAddTo) {}
+
+        void measure(const juce::String& component, const Config& config,
+                     const std::function<void()>& processBlock,
+                     const std::function<void(int)>& beforeBlock = {})
+        {
+            const int blocks = juce::jmax(16, (int)(config.seconds * config.sampleRate / config.blockSize));
+            const int warmup = 8;
+            double total = 0.0, worst = 0.0;
+
+            for (int i = 0; i < warmup + blocks; ++i)
+            {
+                if (beforeBlock) beforeBlock(i);
+
+                const auto start = juce::Time::getHighResolutionTicks();
+                processBlock();
+                const double t = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+                if (i >= warmup)
+                {
+                    total += t;
+                    worst = juce::jmax(worst, t);
+                }
+            }
+
+            // one callback's worth of audio
+            const double budget = config.blockSize / config.sampleRate;
+
+            auto* result = new juce::DynamicObject();
+            result->setProperty("component", component);
+            result->setProperty("blockSize", config.blockSize);
+            result->setProperty("sampleRate", config.sampleRate);
+            result->setProperty("nsPerSample", total * 1.0e9 / ((double)blocks * config.blockSize));
+            result->setProperty("budgetPercent", 100.0 * total / (blocks * budget));
+            result->setProperty("worstBudgetPercent", 100.0 * worst / budget);
+            results.add(juce::var(result));
+
+            // progress on stderr, stdout may be the JSON
+            std::cerr << component << " " << config.blockSize << " @ " << config.sampleRate << ": "
+                      << juce::String(100.0 * total / (blocks * budget), 3) << "% budget" << std::endl;
+        }
+
+    private:
+        juce::Array<juce::var>& results;
+    };
+
+    // stereo test signal: detuned saws and noise, loud enough to keep every stage busy
+    void fillSignal(juce::AudioBuffer<float>& buffer, double sampleRate)
+    {
+        juce::Random random(1234);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            float* data = buffer.getWritePointer(ch);
+            const double freq = ch == 0 ? 110.0 : 110.7;
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                const double phase = std::fmod(i * freq / sampleRate, 1.0);
+                data[i] = 0.3f * (float)(2.0 * phase - 1.0) + 0.1f * (random.nextFloat() * 2.0f - 1.0f);
+            }
+        }
+    }
+
+    // writes the test signal to a temporary WAV so decks go through the real file path
+    bool writeTestTrack(const juce::File& file, double seconds)
+    {
+        const double rate = 44100.0;
+        juce::AudioBuffer<float> signal(2, (int)(seconds * rate));
+        fillSignal(signal, rate);
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+        if (stream == nullptr) return false;
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), rate, 2, 16, {}, 0));
+        if (writer == nullptr) return false;
+        stream.release();
+
+        return writer->writeFromAudioSampleBuffer(signal, 0, signal.getNumSamples());
+    }
+
+    void benchDecks(Bench& bench, const Config& config, juce::AudioFormatManager& formatManager,
+                    juce::TimeSliceThread& ioThread, const juce::URL& track)
+    {
+        struct Variant
+        {
+            const char* name;
+            float speed;
+            TimeStretcher::Mode keylock;
+            bool moveCrossfade;
+        };
+
+        const Variant variants[] = {
+            { "deck", 1.0f, TimeStretcher::Mode::off, false },
+            { "deck.varispeed", 1.06f, TimeStretcher::Mode::off, false },
+            { "deck.keylock.fast", 1.06f, TimeStretcher::Mode::wsola, false },
+            { "deck.keylock.hq", 1.06f, TimeStretcher::Mode::phaseVocoder, false },
+            { "deck.crossfade", 1.0f, TimeStretcher::Mode::off, true }
+        };
+
+        juce::AudioBuffer<float> buffer(2, config.blockSize);
+
+        for (const auto& v : variants)
+        {
+            DJAudioPlayer deck(formatManager, ioThread);
+
+            DJAudioPlayer::Settings settings;
+            settings.speed = v.speed;
+            settings.keylock = v.keylock;
+            deck.applySettings(settings);
+
+            if (deck.loadURLNow(track, 0.0, 120.0) <= 0.0) return;
+            deck.prepareToPlay(config.blockSize, config.sampleRate);
+
+            bench.measure(v.name, config,
+                [&] { deck.getNextAudioBlock(juce::AudioSourceChannelInfo(&buffer, 0, config.blockSize)); },
+                [&](int i)
+                {
+                    // keeps the gain ramp running every block
+                    if (v.moveCrossfade)
+                        deck.setCrossfadeGain((i & 1) != 0 ? 0.3f : 1.0f);
+                });
+
+            deck.releaseResources();
+        }
+    }
+
+    void benchEffects(Bench& bench, const Config& config)
+    {
+        struct Variant
+        {
+            const char* name;
+            float reverb, chorus, compression, delay;
+        };
+
+        const Variant variants[] = {
+            { "effects.none", 0.0f, 0.0f, 0.0f, 0.0f },
+            { "effects.reverb", 0.5f, 0.0f, 0.0f, 0.0f },
+            { "effects.chorus", 0.0f, 0.5f, 0.0f, 0.0f },
+            { "effects.compressor", 0.0f, 0.0f, 0.5f, 0.0f },
+            { "effects.delay", 0.0f, 0.0f, 0.0f, 0.5f },
+            { "effects.all", 0.5f, 0.5f, 0.5f, 0.5f }
+        };
+
+        juce::AudioBuffer<float> input(2, config.blockSize), buffer(2, config.blockSize);
+        fillSignal(input, config.sampleRate);
+
+        for (const auto& v : variants)
+        {
+            EffectsDeck effects;
+            effects.prepare(config.sampleRate, config.blockSize, 2);
+            effects.setDelayTempo(120.0);
+            effects.setReverbAmount(v.reverb);
+            effects.setChorusAmount(v.chorus);
+            effects.setCompressionAmount(v.compression);
+            effects.setDelayAmount(v.delay);
+
+            bench.measure(v.name, config,
+                [&] { effects.process(buffer); },
+                [&](int) { buffer.makeCopyOf(input, true); });
+        }
+    }
+
+    void benchPads(Bench& bench, const Config& config)
+    {
+        SampleAudioSource pads;
+        juce::AudioBuffer<float> buffer(2, config.blockSize);
+
+        // needs Assets/Samples next to the executable or the working directory
+        pads.prepareToPlay(config.blockSize, config.sampleRate);
+        pads.waitForConversion();
+        pads.trigger("glitch");
+        pads.getNextAudioBlock(juce::AudioSourceChannelInfo(&buffer, 0, config.blockSize));
+        if (buffer.getMagnitude(0, config.blockSize) <= 0.0f)
+        {
+            std::cerr << "pad samples not found, skipping pads" << std::endl;
+            return;
+        }
+
+        // the sample is about a second long, restart the voices well before it ends
+        const int blocksPerRound = juce::jmax(1, (int)(0.25 * config.sampleRate / config.blockSize));
+
+        for (int voices : { 1, 2, 4, 8, 16 })
+        {
+            bench.measure("pads." + juce::String(voices), config,
+                [&] { pads.getNextAudioBlock(juce::AudioSourceChannelInfo(&buffer, 0, config.blockSize)); },
+                [&](int i)
+                {
+                    if (i % blocksPerRound != 0) return;
+
+                    // drop the old voices, start exactly this many again
+                    pads.releaseResources();
+                    pads.prepareToPlay(config.blockSize, config.sampleRate);
+                    for (int v = 0; v < voices; ++v)
+                        pads.trigger("glitch");
+                });
+        }
+
+        pads.releaseResources();
+    }
+
+    void benchSpectrum(Bench& bench, const Config& config)
+    {
+        juce::AudioBuffer<float> buffer(2, config.blockSize);
+        fillSignal(buffer, config.sampleRate);
+
+        // audio thread side: mixdown into the fifo of an active tap
+        {
+            SpectrumTap tap{ 10 };
+            tap.setActive(true);
+
+            SpectrumWorker worker;
+            worker.addTap(&tap);
+
+            bench.measure("spectrum.tapPush", config,
+                [&] { tap.push(buffer, 0, config.blockSize); });
+
+            worker.removeTap(&tap);
+        }
+
+        // worker side, a pass at 60 Hz spread over the blocks in between
+        // 1 tap is what the single analyser used to do, 17 is the master plus pre / post fx on 8 decks
+        const int samplesPerPass = (int)(config.sampleRate / 60.0);
+
+        for (int numTaps : { 1, 17 })
+        {
+            juce::OwnedArray<SpectrumTap> taps;
+            SpectrumWorker worker{ false };
+
+            for (int i = 0; i < numTaps; ++i)
+            {
+                auto* tap = taps.add(new SpectrumTap(10));
+                tap->setActive(true);
+                worker.addTap(tap);
+            }
+
+            int pending = 0;
+
+            bench.measure("spectrum.analyse" + juce::String(numTaps), config,
+                [&]
+                {
+                    if (pending < samplesPerPass) return;
+
+                    worker.analyseAll();
+                    pending -= samplesPerPass;
+                },
+                [&](int)
+                {
+                    for (auto* tap : taps)
+                        tap->push(buffer, 0, config.blockSize);
+
+                    pending += config.blockSize;
+                });
+
+            for (auto* tap : taps)
+                worker.removeTap(tap);
+        }
+    }
+
+    // four sources that only write a constant, so this is the mixer's own cost
+    void benchMixer(Bench& bench, const Config& config)
+    {
+        struct Constant : public juce::AudioSource
+        {
+            void prepareToPlay(int, double) override {}
+            void releaseResources() override {}
+            void getNextAudioBlock(const juce::AudioSourceChannelInfo& info) override
+            {
+                for (int ch = 0; ch < info.buffer->getNumChannels(); ++ch)
+                    juce::FloatVectorOperations::fill(info.buffer->getWritePointer(ch, info.startSample), 0.1f, info.numSamples);
+            }
+        };
+
+        Constant sources[4];
+        ParallelMixer mixer;
+        for (auto& s : sources)
+            mixer.addInputSource(&s);
+
+        mixer.prepareToPlay(config.blockSize, config.sampleRate);
+
+        juce::AudioBuffer<float> buffer(2, config.blockSize);
+        bench.measure("mixer.join4", config,
+            [&] { mixer.getNextAudioBlock(juce::AudioSourceChannelInfo(&buffer, 0, config.blockSize)); });
+
+        mixer.releaseResources();
+    }
+}
+
+bool Benchmarks::isRequested(const juce::ArgumentList& args)
+{
+    return args.containsOption("--bench");
+}
+
+int Benchmarks::run(const juce::ArgumentList& args)
+{
+    const bool quick = args.containsOption("--quick");
+
+    double seconds = quick ? 0.5 : 2.0;
+    const auto secondsArg = CommandLineArgs::getValue(args, "--seconds");
+    if (secondsArg.isNotEmpty())
+        seconds = juce::jlimit(0.1, 60.0, secondsArg.getDoubleValue());
+
+    const juce::Array<int> blockSizes = quick ? juce::Array<int>{ 64, 512 }
+                                              : juce::Array<int>{ 32, 64, 128, 256, 512, 1024, 2048 };
+    const juce::Array<double> sampleRates = quick ? juce::Array<double>{ 48000.0 }
+                                                  : juce::Array<double>{ 44100.0, 48000.0, 96000.0 };
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    juce::TimeSliceThread ioThread{ "Bench read-ahead" };
+    ioThread.startThread();
+
+    // long enough for the slowest run at 1.06x
+    juce::TemporaryFile trackFile(".wav");
+    if (!writeTestTrack(trackFile.getFile(), 1.2 * seconds + 5.0))
+    {
+        std::cerr << "couldn't write the test track" << std::endl;
+        return 1;
+    }
+
+    const juce::URL track(trackFile.getFile());
+
+    juce::Array<juce::var> results;
+    Bench bench(results);
+
+    for (double rate : sampleRates)
+    {
+        for (int blockSize : blockSizes)
+        {
+            const Config config{ blockSize, rate, seconds };
+
+            benchDecks(bench, config, formatManager, ioThread, track);
+            benchEffects(bench, config);
+            benchPads(bench, config);
+            benchSpectrum(bench, config);
+            benchMixer(bench, config);
+        }
+    }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("cores", juce::SystemStats::getNumCpus());
+    report->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    report->setProperty("results", results);
+
+    const auto json = juce::JSON::toString(juce::var(report));
+
+    const auto output = CommandLineArgs::getValue(args, "--output");
+    if (output.isEmpty())
+    {
+        std::cout << json << std::endl;
+        return 0;
+    }
+
+    const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(output);
+    if (!file.replaceWithText(json))
+    {
+        std::cerr << "couldn't write " << file.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    Benchmarks.h
+    Created: 18 Oct 2026 1:42:19am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// micro-benchmarks for everything that runs on the audio thread, plus the spectrum worker
+//
+//   PixelSpin --bench [--output results.json] [--seconds 2] [--quick]
+//
+// options take their value as the next argument or after '=' (--seconds=2)
+//
+// decks (plain, varispeed, keylock, moving crossfade), each effect alone and all
+// together, pads with 1..16 voices, the spectrum feed, spectrum analysis of 1 and 17 taps
+// (amortised over the blocks between 60 Hz passes) and the mixer's fork/join,
+// on synthetic input at 32..2048 sample blocks and 44.1/48/96 kHz
+// every result has ns per sample and the share of the callback budget used
+// (mean and worst block), written as JSON to --output or stdout
+class Benchmarks
+{
+public:
+    static bool isRequested(const juce::ArgumentList& args);
+
+    // blocking, returns the process exit code
+    static int run(const juce::ArgumentList& args);
+};
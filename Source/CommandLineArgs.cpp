@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    CommandLineArgs.cpp
+    Created: 18 Oct 2026 6:12:09am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "CommandLineArgs.h"
+
+juce::String CommandLineArgs::getValue(const juce::ArgumentList& args, const juce::String& option)
+{
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto& arg = args[i];
+
+        // --option=value
+        if (arg.text.startsWith(option + "="))
+            return arg.text.fromFirstOccurrenceOf("=", false, false).unquoted();
+
+        if (arg.text != option) continue;
+
+        // --option value
+        if (i + 1 < args.size() && !args[i + 1].isOption())
+            return args[i + 1].text;
+
+        return {};
+    }
+
+    return {};
+}
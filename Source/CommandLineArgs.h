@@ -0,0 +1,23 @@
+/*
+  ==============================================================================
+
+    CommandLineArgs.h
+    Created: 18 Oct 2026 6:12:09am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// https://docs.juce.com/master/structArgumentList.html <-- documentation used
+
+namespace CommandLineArgs
+{
+    // value of a long option, as "--option value" or "--option=value"
+    // juce::ArgumentList::getValueForOption only takes the next argument for short options,
+    // empty if the option is missing or the next argument is another option
+    juce::String getValue(const juce::ArgumentList& args, const juce::String& option);
+}
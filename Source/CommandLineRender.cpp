@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    CommandLineRender.cpp
+    Created: 18 Oct 2026 1:07:44am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "CommandLineRender.h"
+#include "OfflineRenderer.h"
+#include "CommandLineArgs.h"
+
+// https://docs.juce.com/master/structArgumentList.html <-- documentation used
+
+bool CommandLineRender::isRequested(const juce::ArgumentList& args)
+{
+    return args.containsOption("--render");
+}
+
+int CommandLineRender::run(const juce::ArgumentList& args)
+{
+    const auto settingsPath = CommandLineArgs::getValue(args, "--render");
+    if (settingsPath.isEmpty())
+    {
+        std::cerr << "usage: PixelSpin --render mix.json [--output file.wav|file.flac] [--quiet]" << std::endl
+                  << "       (--render=mix.json and --output=file work too)" << std::endl;
+        return badArguments;
+    }
+
+    const auto settingsFile = juce::File::getCurrentWorkingDirectory().getChildFile(settingsPath);
+    if (!settingsFile.existsAsFile())
+    {
+        std::cerr << "settings file not found: " << settingsFile.getFullPathName() << std::endl;
+        return badArguments;
+    }
+
+    // settings
+    juce::var json;
+    const auto parsed = juce::JSON::parse(settingsFile.loadFileAsString(), json);
+    if (parsed.failed())
+    {
+        std::cerr << settingsFile.getFileName() << ": " << parsed.getErrorMessage() << std::endl;
+        return badSettings;
+    }
+
+    MixSettings mix;
+    const auto loaded = MixSettings::fromJSON(json, settingsFile.getParentDirectory(), mix);
+    if (loaded.failed())
+    {
+        std::cerr << settingsFile.getFileName() << ": " << loaded.getErrorMessage() << std::endl;
+        return badSettings;
+    }
+
+    // --output wins over the file's own
+    const auto output = CommandLineArgs::getValue(args, "--output");
+    if (output.isNotEmpty())
+    {
+        mix.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(output);
+        mix.format = mix.outputFile.hasFileExtension("flac") ? MixSettings::Format::flac : MixSettings::Format::wav;
+    }
+
+    if (mix.outputFile == juce::File{})
+    {
+        std::cerr << "no output file, set \"output\" or pass --output" << std::endl;
+        return badArguments;
+    }
+
+    // render
+    const bool quiet = args.containsOption("--quiet");
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    OfflineRenderer renderer(formatManager);
+    int lastPercent = -1;
+
+    const auto result = renderer.render(mix, [&](double progress)
+        {
+            // every 10%
+            const int percent = (int)(progress * 10.0) * 10;
+            if (!quiet && percent != lastPercent)
+            {
+                std::cout << percent << "%" << std::endl;
+                lastPercent = percent;
+            }
+            return true;
+        });
+
+    if (result.failed())
+    {
+        std::cerr << result.getErrorMessage() << std::endl;
+        return renderFailed;
+    }
+
+    // one line that is easy to grep on the build servers
+    std::cout << mix.outputFile.getFullPathName() << ": "
+              << juce::String(renderer.getRenderedSeconds(), 2) << " s audio, "
+              << juce::String(renderer.getWallSeconds(), 3) << " s wall, "
+              << juce::String(renderer.getRealtimeFactor(), 1) << "x realtime" << std::endl;
+
+    return success;
+}
@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    CommandLineRender.h
+    Created: 18 Oct 2026 1:07:44am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// headless mode: renders a mix described in JSON, no window and no audio device
+//
+//   PixelSpin --render mix.json [--output file.wav|file.flac] [--quiet]
+//
+// options take their value as the next argument or after '=' (--output=mix.wav)
+//
+// mix.json:
+//   {
+//     "output": "mix.flac", "sampleRate": 44100, "bitDepth": 24,
+//     "length": 0, "tail": 2, "crossfade": 0.5,
+//     "decks": [ { "file": "a.mp3", "start": 30, "side": "A", "playing": true,
+//                  "gain": 1, "speed": 1, "keylock": "off|fast|hq",
+//                  "reverb": 0, "chorus": 0, "compression": 0,
+//                  "delay": 0, "delayMode": "echo|pingpong", "delaySync": true } ],
+//     "padFolder": "samples", "pads": [ { "time": 4.0, "id": "kick", "gain": 1 } ]
+//   }
+//
+// prints progress and timing to stdout, errors to stderr
+class CommandLineRender
+{
+public:
+    // process exit codes
+    enum ExitCode
+    {
+        success = 0,
+        badArguments = 1,
+        badSettings = 2,
+        renderFailed = 3
+    };
+
+    static bool isRequested(const juce::ArgumentList& args);
+
+    // blocking, returns an ExitCode
+    static int run(const juce::ArgumentList& args);
+};
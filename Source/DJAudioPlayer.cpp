@@ -11,140 +11,465 @@
 #include "DJAudioPlayer.h"
 // handles resampling, effects, and loading/playing
 
-DJAudioPlayer::DJAudioPlayer(juce::AudioFormatManager& _formatManager) : formatManager(_formatManager)
+DJAudioPlayer::DJAudioPlayer(juce::AudioFormatManager& _formatManager, juce::TimeSliceThread& _readAheadThread)
+    : formatManager(_formatManager), readAheadThread(_readAheadThread)
 {
 
 }
 
-DJAudioPlayer::~DJAudioPlayer() 
+DJAudioPlayer::~DJAudioPlayer()
 {
-
+    // stop pending loads and analysis before the track source goes away
+    ++loadGeneration;
+    stopTimer();
+    loaderPool.removeAllJobs(true, 5000);
+    analysisPool.removeAllJobs(true, 5000);
+    cancelPendingUpdate();
 }
 
-void DJAudioPlayer::prepareToPlay(int samplesPerBlockExpected, double sampleRate) 
-{ 
-    transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    resampleSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
+void DJAudioPlayer::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    deviceSampleRate = sampleRate;
+    appliedRatio = 0.0;
+
+    // start from wherever the controls are now, no ramp
+    parameters.update();
+
+    smoothedGain.reset(sampleRate, 0.02);
+    smoothedGain.setCurrentAndTargetValue(parameters[gainParam]);
+    smoothedCrossfade.reset(sampleRate, 0.02);
+    smoothedCrossfade.setCurrentAndTargetValue(parameters[crossfadeParam]);
+    smoothedSpeed.reset(sampleRate, 0.05);
+    smoothedSpeed.setCurrentAndTargetValue(parameters[speedParam]);
+
+    gainRamp.assign((size_t)juce::jmax(16, samplesPerBlockExpected), 0.0f);
+
+    // prepares the resampler and the track below it
+    stretcher.prepareToPlay(samplesPerBlockExpected, sampleRate);
 
     // effects
     effects.prepare(sampleRate, samplesPerBlockExpected, 2);
+    effects.setReverbAmount(parameters[reverbParam]);
+    effects.setChorusAmount(parameters[chorusParam]);
+    effects.setCompressionAmount(parameters[compressionParam]);
+    effects.setDelayMode((StereoDelay::Mode)(int)parameters[delayModeParam]);
+    effects.setDelaySync(parameters[delaySyncParam] > 0.5f);
+    effects.setDelayAmount(parameters[delayParam]);
+    appliedBpm = -1.0;
+
+    // spectra start over, the worker does the clearing
+    preFxTap.reset();
+    postFxTap.reset();
 }
 
-void DJAudioPlayer::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) 
+void DJAudioPlayer::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
 {
-    resampleSource.getNextAudioBlock(bufferToFill);
+    applyParameterChanges();
+
+    // speed at the end of this block, the resampler glides there sample by sample
+    const double currentSpeed = smoothedSpeed.skip(bufferToFill.numSamples);
+
+    // mode is picked up here so the ratio and the stretcher always agree
+    // near standstill there is nothing to stretch, plain varispeed takes over
+    const auto mode = currentSpeed >= TimeStretcher::minTempo
+                    ? (TimeStretcher::Mode)keylockMode.load(std::memory_order_relaxed)
+                    : TimeStretcher::Mode::off;
+
+    stretcher.setMode(mode);
+    const bool keylock = mode != TimeStretcher::Mode::off;
+
+    // file rate and speed in a single ratio, or just the file rate when keylocked
+    const double fileRate = trackSource.getSourceSampleRate();
+    const double ratio = (keylock ? 1.0 : currentSpeed)
+                       * (fileRate > 0.0 ? fileRate / deviceSampleRate : 1.0);
+
+    if (ratio != appliedRatio)
+    {
+        resampleSource.setResamplingRatio(ratio);
+        appliedRatio = ratio;
+    }
+
+    if (keylock)
+        stretcher.setTempo(currentSpeed);
+
+    publishPlayhead(currentSpeed, keylock);
+
+    // synced delay follows the tempo as it is heard
+    // while the speed glides only a real change retargets it, the exact tempo once it settles
+    const double bpm = trackBpm.load(std::memory_order_relaxed) * currentSpeed;
+    const double bpmChange = std::abs(bpm - appliedBpm);
+    if (bpmChange > 0.5 || (bpmChange > 0.01 && !smoothedSpeed.isSmoothing()))
+    {
+        effects.setDelayTempo(bpm);
+        appliedBpm = bpm;
+    }
+
+    // passes straight through to the resampler when keylock is off
+    {
+        const AudioProfiler::ScopedTimer timer(profiler, AudioProfiler::getDeckStage(profilerDeck, keylock ? AudioProfiler::keylockStage
+                                                                                                           : AudioProfiler::resampleStage));
+        stretcher.getNextAudioBlock(bufferToFill);
+    }
+
+    applyGain(bufferToFill);
+    preFxTap.push(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
 
     // effects
     effects.process(*bufferToFill.buffer);
+    postFxTap.push(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+}
+
+void DJAudioPlayer::publishPlayhead(double speed, bool keylock)
+{
+    const double latency = outputLatency != nullptr ? outputLatency->load(std::memory_order_relaxed) : 0.0;
+
+    const double fileRate = trackSource.getSourceSampleRate();
+    if (fileRate <= 0.0)
+    {
+        playhead.publish(0.0, 0.0, latency);
+        return;
+    }
+
+    // read from the file but not heard yet: waiting in the resampler, and the stretcher's latency
+    double pending = resampleSource.getBufferedInputSamples();
+    if (keylock)
+        pending += stretcher.getLatencySamples() * speed * fileRate / deviceSampleRate;
+
+    const double seconds = juce::jmax(0.0, ((double)trackSource.getPosition() - pending) / fileRate);
+    playhead.publish(seconds, trackSource.isPlaying() ? speed : 0.0, latency);
+}
+
+void DJAudioPlayer::setProfiler(AudioProfiler* p, int deck)
+{
+    profiler = p;
+    profilerDeck = deck;
+    effects.setProfiler(p, deck);
+}
+
+void DJAudioPlayer::applyParameterChanges()
+{
+    const juce::uint32 changed = parameters.update();
+    if (changed == 0) return;
+
+    if (changed & ParameterStore::bit(gainParam)) smoothedGain.setTargetValue(parameters[gainParam]);
+    if (changed & ParameterStore::bit(crossfadeParam)) smoothedCrossfade.setTargetValue(parameters[crossfadeParam]);
+    if (changed & ParameterStore::bit(speedParam)) smoothedSpeed.setTargetValue(parameters[speedParam]);
+
+    // coefficients are only recomputed for the knob that moved
+    if (changed & ParameterStore::bit(reverbParam)) effects.setReverbAmount(parameters[reverbParam]);
+    if (changed & ParameterStore::bit(chorusParam)) effects.setChorusAmount(parameters[chorusParam]);
+    if (changed & ParameterStore::bit(compressionParam)) effects.setCompressionAmount(parameters[compressionParam]);
+    if (changed & ParameterStore::bit(delayModeParam)) effects.setDelayMode((StereoDelay::Mode)(int)parameters[delayModeParam]);
+    if (changed & ParameterStore::bit(delaySyncParam)) effects.setDelaySync(parameters[delaySyncParam] > 0.5f);
+    if (changed & ParameterStore::bit(delayParam)) effects.setDelayAmount(parameters[delayParam]);
+}
+
+void DJAudioPlayer::applyGain(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    auto& buffer = *bufferToFill.buffer;
+
+    // settled: one multiply per sample, or nothing at unity
+    if (!smoothedGain.isSmoothing() && !smoothedCrossfade.isSmoothing())
+    {
+        const float g = smoothedGain.getTargetValue() * smoothedCrossfade.getTargetValue();
+        if (g != 1.0f)
+            buffer.applyGain(bufferToFill.startSample, bufferToFill.numSamples, g);
+        return;
+    }
+
+    // moving: build the gain curve once, then apply it to every channel
+    int done = 0;
+    while (done < bufferToFill.numSamples)
+    {
+        const int num = juce::jmin((int)gainRamp.size(), bufferToFill.numSamples - done);
+
+        for (int i = 0; i < num; ++i)
+            gainRamp[(size_t)i] = smoothedGain.getNextValue() * smoothedCrossfade.getNextValue();
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            juce::FloatVectorOperations::multiply(buffer.getWritePointer(ch, bufferToFill.startSample + done), gainRamp.data(), num);
+
+        done += num;
+    }
 }
 
 void DJAudioPlayer::releaseResources() {
-    transportSource.releaseResources();
-    resampleSource.releaseResources();
+    stretcher.releaseResources();
 
     // release effects
     effects.reset();
 }
 
-void DJAudioPlayer::loadURL(juce::URL audioURL) 
+void DJAudioPlayer::loadURL(juce::URL audioURL, bool startWhenLoaded)
 {
-    // convert audioURL to input stream and create reader
-    auto* reader = formatManager.createReaderFor(audioURL.createInputStream(false));
+    const int generation = ++loadGeneration;
+
+    loaderPool.addJob([this, audioURL, startWhenLoaded, generation]()
+        {
+            // a newer load was requested while this one waited
+            if (generation != loadGeneration.load()) return;
+
+            // free whatever the audio thread swapped out last time
+            trackSource.collectGarbage();
+
+            auto track = std::make_unique<TrackSwapSource::LoadedTrack>();
+            track->source = createStream(audioURL, track->sampleRate);
+
+            //if file reader OK
+            if (track->source == nullptr) return;
+
+            track->url = audioURL;
+            track->startPlaying = startWhenLoaded;
+
+            // decode / fault in the first window here so playback starts without an underrun
+            track->source->prime();
+
+            // hands the source to the i/o thread
+            track->source->prepareToPlay(0, track->sampleRate);
+
+            if (generation != loadGeneration.load()) return;
+
+            // old track's tempo no longer applies
+            trackBpm.store(0.0);
+            trackSource.publish(std::move(track));
+
+            {
+                const juce::ScopedLock sl(loadedLock);
+                loadedURL = audioURL;
+            }
+
+            // notify listeners of new URL, the old track is freed once the audio thread lets go (timerCallback)
+            triggerAsyncUpdate();
+
+            // tempo for synced effects on its own low priority thread, so the next load never waits for it
+            analysisPool.addJob([this, audioURL, generation]()
+                {
+                    auto superseded = [this, generation]() { return generation != loadGeneration.load(); };
+                    if (superseded()) return;
 
-    //if file reader OK
-    if (reader != nullptr) 
+                    // a reader of its own, the track already plays
+                    std::unique_ptr<juce::AudioFormatReader> analysisReader(formatManager.createReaderFor(audioURL.createInputStream(false)));
+                    if (analysisReader == nullptr) return;
+
+                    const double bpm = TempoEstimator::estimate(*analysisReader, 30.0, superseded);
+
+                    if (!superseded())
+                        trackBpm.store(bpm);
+                });
+        });
+}
+
+double DJAudioPlayer::loadURLNow(const juce::URL& audioURL, double startSeconds, double bpm, bool startPlaying)
+{
+    // drop any background load still running
+    ++loadGeneration;
+    loaderPool.removeAllJobs(true, 5000);
+    analysisPool.removeAllJobs(true, 5000);
+    trackSource.collectGarbage();
+
+    auto track = std::make_unique<TrackSwapSource::LoadedTrack>();
+    track->source = createStream(audioURL, track->sampleRate, true);
+    if (track->source == nullptr) return 0.0;
+
+    track->url = audioURL;
+    track->startPlaying = startPlaying;
+
+    const double lengthSeconds = (double)track->source->getTotalLength() / track->sampleRate;
+
+    track->source->setNextReadPosition((juce::int64)(juce::jmax(0.0, startSeconds) * track->sampleRate));
+    track->source->prime();
+    track->source->prepareToPlay(0, track->sampleRate);
+
+    if (bpm <= 0.0)
     {
-        // create audio format reader source
-        std::unique_ptr<juce::AudioFormatReaderSource> newSource(new juce::AudioFormatReaderSource(reader, true));
+        std::unique_ptr<juce::AudioFormatReader> analysisReader(formatManager.createReaderFor(audioURL.createInputStream(false)));
+        if (analysisReader != nullptr)
+            bpm = TempoEstimator::estimate(*analysisReader);
+    }
+
+    trackBpm.store(bpm);
+    trackSource.publish(std::move(track));
+
+    // nobody listens to offline decks
+    currentURL = audioURL;
+    return lengthSeconds;
+}
 
-        // pass into transport source
-        transportSource.setSource(newSource.get(), 0, nullptr, reader->sampleRate);
-        readerSource.reset(newSource.release());
+std::unique_ptr<DeckStream> DJAudioPlayer::createStream(const juce::URL& url, double& sampleRate, bool synchronous)
+{
+    // uncompressed local files play straight from a memory mapping
+    if (url.isLocalFile())
+    {
+        const auto file = url.getLocalFile();
 
-        currentURL = audioURL;
+        if (auto* format = formatManager.findFormatForFileExtension(file.getFileExtension()))
+        {
+            // only WAV and AIFF hand out mapped readers, others return nullptr
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(file));
 
-        // notify listeners of new URL
-        sendChangeMessage();
+            if (mapped != nullptr && mapped->mapEntireFile())
+            {
+                sampleRate = mapped->sampleRate;
+                return std::make_unique<MappedTrackSource>(mapped.release(), readAheadThread, readAheadSeconds.load());
+            }
+        }
     }
+
+    // convert audioURL to input stream and create reader
+    auto* reader = formatManager.createReaderFor(url.createInputStream(false));
+    if (reader == nullptr) return nullptr;
+
+    sampleRate = reader->sampleRate;
+
+    // create read-ahead source, decoding happens on the shared i/o thread
+    return std::make_unique<ReadAheadSource>(reader, synchronous ? nullptr : &readAheadThread, readAheadSeconds.load());
 }
 
-void DJAudioPlayer::setGain(double gain) 
+void DJAudioPlayer::handleAsyncUpdate()
 {
-    if (gain >= 0 && gain <= 1.0) 
     {
-        transportSource.setGain(gain);
+        const juce::ScopedLock sl(loadedLock);
+        currentURL = loadedURL;
     }
+
+    sendChangeMessage();
+
+    // no polling on the loader, which stays free for the next track
+    startTimer(50);
 }
 
-void DJAudioPlayer::setSpeed(double ratio) 
+void DJAudioPlayer::timerCallback()
 {
-    resampleSource.setResamplingRatio(ratio);
+    // no device calling back yet, the next load frees it otherwise
+    if (trackSource.isPending()) return;
+
+    stopTimer();
+
+    // a mapped file or a decoder, closed off the message thread
+    loaderPool.addJob([this]() { trackSource.collectGarbage(); });
+}
+
+void DJAudioPlayer::setGain(double newGain)
+{
+    if (newGain >= 0 && newGain <= 1.0)
+    {
+        parameters.set(gainParam, (float)newGain);
+    }
 }
 
-void DJAudioPlayer::setPosition(double posInSecs) 
+void DJAudioPlayer::setSpeed(double ratio)
 {
-    transportSource.setPosition(posInSecs);
+    // picked up by the audio thread on the next block
+    parameters.set(speedParam, (float)ratio);
 }
 
-void DJAudioPlayer::setPositionRelative(double pos) 
+DJAudioPlayer::Settings DJAudioPlayer::getSettings() const
+{
+    Settings s;
+    s.gain = parameters.get(gainParam);
+    s.speed = parameters.get(speedParam);
+    s.reverb = parameters.get(reverbParam);
+    s.chorus = parameters.get(chorusParam);
+    s.compression = parameters.get(compressionParam);
+    s.delay = parameters.get(delayParam);
+    s.delayMode = (StereoDelay::Mode)(int)parameters.get(delayModeParam);
+    s.delaySync = parameters.get(delaySyncParam) > 0.5f;
+    s.keylock = getKeylock();
+    return s;
+}
+
+void DJAudioPlayer::applySettings(const Settings& s)
+{
+    setGain(s.gain);
+    setSpeed(s.speed);
+    setReverbAmount(s.reverb);
+    setChorusAmount(s.chorus);
+    setCompressionAmount(s.compression);
+    setDelayAmount(s.delay);
+    setDelayMode(s.delayMode);
+    setDelaySync(s.delaySync);
+    setKeylock(s.keylock);
+}
+
+void DJAudioPlayer::setCrossfadeGain(float newGain)
+{
+    // separate from the volume slider, the two multiply
+    parameters.set(crossfadeParam, juce::jlimit(0.0f, 1.0f, newGain));
+}
+
+void DJAudioPlayer::setPosition(double posInSecs)
+{
+    const double rate = trackSource.getSourceSampleRate();
+    if (rate > 0.0)
+    {
+        trackSource.setPosition((juce::int64)(posInSecs * rate));
+    }
+}
+
+void DJAudioPlayer::setPositionRelative(double pos)
 {
     if (pos >= 0 && pos <= 1) {
-        double posInSecs = transportSource.getLengthInSeconds() * pos;
+        double posInSecs = getTrackLengthSeconds() * pos;
         setPosition(posInSecs);
     }
 }
 
-void DJAudioPlayer::start() 
+void DJAudioPlayer::start()
 {
-    transportSource.start();
+    trackSource.start();
 }
 
-void DJAudioPlayer::stop() 
+void DJAudioPlayer::stop()
 {
-    transportSource.stop();
+    trackSource.stop();
 }
 
 double DJAudioPlayer::getPositionRelative()
 {
-    const double len = transportSource.getLengthInSeconds();
+    const double len = getTrackLengthSeconds();
     if (len <= 0.0) return 0.0;
 
-    return transportSource.getCurrentPosition() / len;
+    return getPositionSeconds() / len;
 }
 
 bool DJAudioPlayer::isPlaying() const
 {
-    return transportSource.isPlaying();
+    return trackSource.isPlaying();
 }
-    
+
 
 // methods for exporting
 double DJAudioPlayer::getPositionSeconds() const
 {
-    return transportSource.getCurrentPosition();
+    const double rate = trackSource.getSourceSampleRate();
+    return rate > 0.0 ? (double)trackSource.getPosition() / rate : 0.0;
 }
 
 
 // length of the loaded track in seconds
 double DJAudioPlayer::getTrackLengthSeconds() const
 {
-    // transport knows the exact length
-    const double len = transportSource.getLengthInSeconds();
-    if (std::isfinite(len) && len > 0.0)
-    {
-        return len;
-    }
+    // published by the audio thread when the track was swapped in
+    const double rate = trackSource.getSourceSampleRate();
+    if (rate <= 0.0) return 0.0;
 
-    // compute from the reader if available
-    if (readerSource != nullptr)
-    {
-        if (auto* r = readerSource->getAudioFormatReader())
-        {
-            if (r->sampleRate > 0.0)
-            {
-                return (double)r->lengthInSamples / r->sampleRate;
-            }
-        }
-    }
-    return 0.0;
-}
\ No newline at end of file
+    const double len = (double)trackSource.getLength() / rate;
+    return std::isfinite(len) && len > 0.0 ? len : 0.0;
+}
+
+
+// streaming
+void DJAudioPlayer::setReadAheadSeconds(double seconds)
+{
+    readAheadSeconds.store(juce::jlimit(0.5, 30.0, seconds));
+}
+
+float DJAudioPlayer::getBufferHealth() const
+{
+    return trackSource.getBufferHealth();
+}
+
+int DJAudioPlayer::getBufferUnderruns() const
+{
+    return trackSource.getUnderrunCount();
+}
@@ -3,24 +3,63 @@
 #include <JuceHeader.h>
 #include "EffectsDeck.h"
 #include "MixerStrip.h"
-
-
-class DJAudioPlayer : public juce::AudioSource, public juce::ChangeBroadcaster
+#include "ReadAheadSource.h"
+#include "MappedTrackSource.h"
+#include "TrackSwapSource.h"
+#include "SincResamplingSource.h"
+#include "TimeStretcher.h"
+#include "ParameterStore.h"
+#include "TempoEstimator.h"
+#include "AudioProfiler.h"
+#include "SpectrumAnalyser.h"
+#include "PlayheadClock.h"
+
+
+class DJAudioPlayer : public juce::AudioSource,
+                      public juce::ChangeBroadcaster,
+                      private juce::AsyncUpdater,
+                      private juce::Timer
 {
 public:
-    DJAudioPlayer(juce::AudioFormatManager& _formatManager);
+    DJAudioPlayer(juce::AudioFormatManager& _formatManager, juce::TimeSliceThread& _readAheadThread);
     ~DJAudioPlayer();
 
     void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
     void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
     void releaseResources() override;
 
-    // loads track
-    void loadURL(juce::URL audioURL);
-
-    // setters
+    // loads track on a worker thread, returns straight away
+    // listeners are notified once the track is handed over, the audio thread takes it at its next block
+    void loadURL(juce::URL audioURL, bool startWhenLoaded = false);
+
+    // offline export: opens the track on the calling thread and cues it at startSeconds,
+    // playing unless startPlaying is false
+    // compressed files are decoded as the deck renders instead of on the i/o thread
+    // bpm 0 estimates it here, returns the track length in seconds (0 if it can't be read)
+    double loadURLNow(const juce::URL& audioURL, double startSeconds, double bpm = 0.0, bool startPlaying = true);
+
+    // every control value, to copy a deck into the offline renderer
+    struct Settings
+    {
+        float gain{ 1.0f };
+        float speed{ 1.0f };
+        float reverb{ 0.0f };
+        float chorus{ 0.0f };
+        float compression{ 0.0f };
+        float delay{ 0.0f };
+        StereoDelay::Mode delayMode{ StereoDelay::Mode::stereo };
+        bool delaySync{ true };
+        TimeStretcher::Mode keylock{ TimeStretcher::Mode::off };
+    };
+
+    // any thread, last values written
+    Settings getSettings() const;
+    void applySettings(const Settings& settings);
+
+    // setters, any thread, smoothed on the audio thread
     void setGain(double gain);
     void setSpeed(double ratio);
+    void setCrossfadeGain(float gain);
     void setPosition(double posInSecs);
     void setPositionRelative(double pos);
 
@@ -38,35 +77,170 @@ public:
     bool isPlaying() const;
 
     // -- EFFECTS --
-    
+
+    // handed to the effects on the audio thread, only when they change
+
     // reverb setter
-    void setReverbAmount(float wet01) { effects.setReverbAmount(wet01); }
+    void setReverbAmount(float wet01) { parameters.set(reverbParam, juce::jlimit(0.0f, 1.0f, wet01)); }
 
     // chorus setter
-    void setChorusAmount(float amt01) { effects.setChorusAmount(amt01); }
+    void setChorusAmount(float amt01) { parameters.set(chorusParam, juce::jlimit(0.0f, 1.0f, amt01)); }
 
     // compression setter
-    void setCompressionAmount(float amt01) { effects.setCompressionAmount(amt01); }
+    void setCompressionAmount(float amt01) { parameters.set(compressionParam, juce::jlimit(0.0f, 1.0f, amt01)); }
 
     // delay setter
-    void setDelayAmount(float amt01) { effects.setDelayAmount(amt01); }
+    void setDelayAmount(float amt01) { parameters.set(delayParam, juce::jlimit(0.0f, 1.0f, amt01)); }
+
+    // stereo or ping-pong echoes
+    void setDelayMode(StereoDelay::Mode mode) { parameters.set(delayModeParam, (float)mode); }
+
+    // lock delay times to the track tempo (falls back to free time while the bpm is unknown)
+    void setDelaySync(bool shouldSync) { parameters.set(delaySyncParam, shouldSync ? 1.0f : 0.0f); }
+
+    // estimated on load, 0 until known
+    double getTrackBpm() const { return trackBpm.load(std::memory_order_relaxed); }
+
+    // read only, for the fx activity readout
+    const EffectsDeck& getEffects() const { return effects; }
+
+    // spectrum taps either side of the fx, register them with a SpectrumWorker to analyse
+    SpectrumTap& getPreFxTap() { return preFxTap; }
+    SpectrumTap& getPostFxTap() { return postFxTap; }
+
+    // position as heard, smooth enough to draw every frame
+    const PlayheadClock& getPlayhead() const { return playhead; }
+
+    // how long the device takes to play what the deck renders, read at every publish
+    // set before the deck goes live, nullptr (offline) is none
+    void setOutputLatency(const std::atomic<double>* seconds) { outputLatency = seconds; }
 
     // exporting methods
     double getPositionSeconds() const;
     double getTrackLengthSeconds() const;
 
+    // -- STREAMING --
+
+    // seconds decoded ahead of the playhead, applies from the next load
+    void setReadAheadSeconds(double seconds);
+
+    // 0..1 fill level of the read-ahead buffer (1 when nothing is loaded)
+    float getBufferHealth() const;
+
+    // times the decoder fell behind the audio callback
+    int getBufferUnderruns() const;
+
+    // interpolation quality for speed and sample rate changes
+    void setResamplerQuality(SincResamplingSource::Quality q) { resampleSource.setQuality(q); }
+
+    // -- KEYLOCK --
+
+    // speed changes tempo only, pitch stays put (off: speed changes both)
+    void setKeylock(TimeStretcher::Mode mode) { keylockMode.store((int)mode, std::memory_order_relaxed); }
+    TimeStretcher::Mode getKeylock() const { return (TimeStretcher::Mode)keylockMode.load(std::memory_order_relaxed); }
+
+    // extra output delay of the active keylock mode, in device samples
+    int getKeylockLatencySamples() const { return stretcher.getLatencySamples(); }
+
+    // -- PROFILING --
+
+    // times the resampler / keylock and every fx stage under this deck index, before playback starts
+    void setProfiler(AudioProfiler* p, int deck);
+
 
 private:
+    // every control the gui can move, in ParameterStore order
+    enum Param
+    {
+        gainParam = 0,
+        speedParam,
+        crossfadeParam,
+        reverbParam,
+        chorusParam,
+        compressionParam,
+        delayParam,
+        delayModeParam,
+        delaySyncParam
+    };
+
+    // audio thread: pull changed controls into the smoothers and effects
+    void applyParameterChanges();
+
+    // audio thread: volume times crossfade, per sample while either is moving
+    void applyGain(const juce::AudioSourceChannelInfo& bufferToFill);
+
+    // audio thread: where the next output sample is in the track, past the resampler and stretcher
+    void publishPlayhead(double speed, bool keylock);
+
+    // finished loads land here on the message thread
+    void handleAsyncUpdate() override;
+
+    // message thread: once the audio thread has taken a new track, the loader frees the old one
+    void timerCallback() override;
+
+    // loader thread: memory mapped for WAV/AIFF files, decoded read-ahead for everything else
+    // synchronous streams decode on the thread that renders them
+    std::unique_ptr<DeckStream> createStream(const juce::URL& url, double& sampleRate, bool synchronous = false);
+
     // audio & playback
     juce::AudioFormatManager& formatManager;
-    std::unique_ptr<juce::AudioFormatReaderSource> readerSource;
-    juce::AudioTransportSource transportSource;
 
-    juce::ResamplingAudioSource resampleSource{ &transportSource, false, 2 };
+    // shared between decks, decodes ahead of each playhead
+    juce::TimeSliceThread& readAheadThread;
+    std::atomic<double> readAheadSeconds{ 2.0 };
+
+    // current track and play state, swapped without locks
+    TrackSwapSource trackSource;
+
+    // one sinc pass covers file rate -> device rate and the speed slider
+    SincResamplingSource resampleSource{ &trackSource, 2 };
+    double deviceSampleRate{ 44100.0 };
+    double appliedRatio{ 0.0 };
+
+    // with keylock on the resampler only converts the rate and this applies the speed
+    TimeStretcher stretcher{ &resampleSource, 2 };
+    std::atomic<int> keylockMode{ (int)TimeStretcher::Mode::off };
+
+    AudioProfiler* profiler{ nullptr };
+    int profilerDeck{ 0 };
+
+    // written by the gui, read once per block
+    ParameterStore parameters{ 1.0f /*gain*/, 1.0f /*speed*/, 1.0f /*crossfade*/,
+                               0.0f /*reverb*/, 0.0f /*chorus*/, 0.0f /*compression*/, 0.0f /*delay*/,
+                               0.0f /*delay mode*/, 1.0f /*delay sync*/ };
+
+    // per sample smoothing, no zipper noise when a control jumps
+    juce::SmoothedValue<float> smoothedGain;
+    juce::SmoothedValue<float> smoothedCrossfade;
+    juce::SmoothedValue<double> smoothedSpeed;
+    std::vector<float> gainRamp;
+
+    // track tempo from the loader, times speed for the delay
+    std::atomic<double> trackBpm{ 0.0 };
+    double appliedBpm{ -1.0 };
 
     juce::URL currentURL;
 
+    // url of the last finished load, handed from the loader to the message thread
+    juce::CriticalSection loadedLock;
+    juce::URL loadedURL;
+
+    // newest load wins, older jobs still running give up
+    std::atomic<int> loadGeneration{ 0 };
+
     // effect deck
     // handles all effects and don't have to processs each individually
     EffectsDeck effects;
+
+    // only copy audio while a display shows them
+    SpectrumTap preFxTap, postFxTap;
+
+    // published every block for the ui
+    PlayheadClock playhead;
+    const std::atomic<double>* outputLatency{ nullptr };
+
+    // opens and primes new tracks off the message thread, then hands the tempo to analysisPool
+    // declared last so running jobs finish before anything else is destroyed
+    juce::ThreadPool analysisPool{ 1, 0, juce::Thread::Priority::low };
+    juce::ThreadPool loaderPool{ 1 };
 };
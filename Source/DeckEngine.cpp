@@ -0,0 +1,168 @@
+/*
+  ==============================================================================
+
+    DeckEngine.cpp
+    Created: 17 Oct 2026 11:58:02pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "DeckEngine.h"
+
+static_assert(DeckEngine::maxDecks <= AudioProfiler::maxDecks, "every slot needs its profiler stages");
+
+DeckEngine::DeckEngine(juce::AudioFormatManager& fmt, juce::TimeSliceThread& readAhead)
+    : formatManager(fmt),
+      readAheadThread(readAhead)
+{
+    for (int slot = 0; slot < maxDecks; ++slot)
+        slotSources.add(new SlotSource(*this, slot));
+}
+
+DeckEngine::~DeckEngine()
+{
+    // audio is stopped by now
+    stopTimer();
+
+    for (auto& deck : live)
+        deck.store(nullptr);
+
+    retired.clear();
+}
+
+int DeckEngine::addDeck(Side side)
+{
+    for (int slot = 0; slot < maxDecks; ++slot)
+    {
+        if (owned[(size_t)slot] != nullptr) continue;
+
+        auto deck = std::make_unique<DJAudioPlayer>(formatManager, readAheadThread);
+        deck->setProfiler(profiler, slot);
+        deck->setOutputLatency(&outputLatency);
+
+        // ready before the audio thread can see it
+        const int blockSize = preparedBlockSize.load();
+        if (blockSize > 0)
+            deck->prepareToPlay(blockSize, preparedSampleRate.load());
+
+        sides[(size_t)slot] = side;
+        owned[(size_t)slot] = std::move(deck);
+        applyCrossfade();
+
+        live[(size_t)slot].store(owned[(size_t)slot].get());
+        return slot;
+    }
+
+    return -1;
+}
+
+void DeckEngine::removeDeck(int slot)
+{
+    if (!juce::isPositiveAndBelow(slot, maxDecks) || owned[(size_t)slot] == nullptr) return;
+
+    owned[(size_t)slot]->stop();
+
+    // the block running now may still hold it, free it after the next one starts
+    live[(size_t)slot].store(nullptr);
+    retired.push_back({ std::move(owned[(size_t)slot]), blockCount.load() });
+
+    startTimer(50);
+}
+
+DJAudioPlayer* DeckEngine::getDeck(int slot) const
+{
+    return juce::isPositiveAndBelow(slot, maxDecks) ? owned[(size_t)slot].get() : nullptr;
+}
+
+int DeckEngine::getNumDecks() const
+{
+    int count = 0;
+    for (auto& deck : owned)
+        count += deck != nullptr ? 1 : 0;
+
+    return count;
+}
+
+void DeckEngine::setOutputLatency(double seconds)
+{
+    // every deck reads it when it publishes its playhead
+    outputLatency.store(seconds, std::memory_order_relaxed);
+}
+
+void DeckEngine::setSide(int slot, Side side)
+{
+    if (!juce::isPositiveAndBelow(slot, maxDecks)) return;
+
+    sides[(size_t)slot] = side;
+    applyCrossfade();
+}
+
+void DeckEngine::setCrossfade(float x)
+{
+    crossfade = juce::jlimit(0.0f, 1.0f, x);
+    applyCrossfade();
+}
+
+float DeckEngine::getSideGain(Side side, float x)
+{
+    if (side == Side::thru) return 1.0f;
+
+    const bool onB = side == Side::b;
+
+    // hard endpoints to guarantee isolation on snaps
+    if (x <= 1e-4f) return onB ? 0.0f : 1.0f;
+    if (x >= 1.0f - 1e-4f) return onB ? 1.0f : 0.0f;
+
+    // equal power crossfade
+    const float theta = x * juce::MathConstants<float>::halfPi;
+    return onB ? std::sin(theta) * std::sin(theta) : std::cos(theta) * std::cos(theta);
+}
+
+void DeckEngine::applyCrossfade()
+{
+    for (int slot = 0; slot < maxDecks; ++slot)
+        if (auto* deck = owned[(size_t)slot].get())
+            deck->setCrossfadeGain(getSideGain(sides[(size_t)slot], crossfade));
+}
+
+void DeckEngine::timerCallback()
+{
+    // nothing is rendering while the device is stopped
+    const bool running = preparedBlockSize.load() > 0;
+    const auto now = blockCount.load();
+
+    retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                 [&](const Retired& r) { return !running || r.block != now; }),
+                  retired.end());
+
+    if (retired.empty())
+        stopTimer();
+}
+
+//==============================================================================
+void DeckEngine::SlotSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    owner.preparedSampleRate.store(sampleRate);
+    owner.preparedBlockSize.store(samplesPerBlockExpected);
+
+    if (auto* deck = owner.owned[(size_t)slot].get())
+        deck->prepareToPlay(samplesPerBlockExpected, sampleRate);
+}
+
+void DeckEngine::SlotSource::releaseResources()
+{
+    owner.preparedBlockSize.store(0);
+
+    if (auto* deck = owner.owned[(size_t)slot].get())
+        deck->releaseResources();
+}
+
+void DeckEngine::SlotSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+{
+    if (auto* deck = owner.live[(size_t)slot].load())
+        deck->getNextAudioBlock(info);
+    else
+        info.clearActiveBufferRegion();
+}
@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    DeckEngine.h
+    Created: 17 Oct 2026 11:58:02pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DJAudioPlayer.h"
+
+// owns any number of decks up to maxDecks and where they sit on the crossfader
+// decks live in fixed slots so the audio side never reallocates:
+// the mixer renders one slot per job, empty slots are switched off there and cost nothing
+// decks are created on the message thread, published through an atomic
+// pointer, and freed a block after removal once the audio thread has let go
+class DeckEngine : private juce::Timer
+{
+public:
+    static constexpr int maxDecks = 8;
+
+    // crossfader assignment, thru ignores the crossfader
+    enum class Side { a = 0, b, thru };
+
+    DeckEngine(juce::AudioFormatManager& formatManager, juce::TimeSliceThread& readAheadThread);
+    ~DeckEngine() override;
+
+    // -- message thread --
+
+    // returns the slot of the new deck, -1 when all slots are taken
+    int addDeck(Side side);
+    void removeDeck(int slot);
+
+    // nullptr for empty slots
+    DJAudioPlayer* getDeck(int slot) const;
+    int getNumDecks() const;
+
+    void setSide(int slot, Side side);
+    Side getSide(int slot) const { return sides[(size_t)slot]; }
+
+    // 0 = side A only, 1 = side B only, equal power in between
+    void setCrossfade(float x);
+    float getCrossfade() const { return crossfade; }
+
+    // gain of a deck on this side at crossfader position x
+    static float getSideGain(Side side, float x);
+
+    // new decks report their stage timings here, under their slot
+    void setProfiler(AudioProfiler* p) { profiler = p; }
+
+    // device latency for every deck's playhead, current and new
+    // any thread, it never touches the decks themselves
+    void setOutputLatency(double seconds);
+
+    // -- mixer --
+
+    // one source per slot, hand all of them to the mixer before audio starts
+    juce::AudioSource& getSlotSource(int slot) { return *slotSources.getUnchecked(slot); }
+
+    // audio thread, once per callback before any slot renders
+    void beginBlock() { blockCount.fetch_add(1); }
+
+private:
+    // renders whatever deck is in its slot
+    class SlotSource : public juce::AudioSource
+    {
+    public:
+        SlotSource(DeckEngine& o, int index) : owner(o), slot(index) {}
+
+        void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+        void releaseResources() override;
+        void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    private:
+        DeckEngine& owner;
+        const int slot;
+    };
+
+    // crossfade gain for every deck from its side
+    void applyCrossfade();
+
+    // frees removed decks once the audio thread is past them
+    void timerCallback() override;
+
+    juce::AudioFormatManager& formatManager;
+    juce::TimeSliceThread& readAheadThread;
+
+    // per slot state, one fixed array per field indexed by slot
+    // the decks themselves are on the heap, these hold pointers to them
+    std::array<std::atomic<DJAudioPlayer*>, maxDecks> live{};      // read by the audio thread
+    std::array<std::unique_ptr<DJAudioPlayer>, maxDecks> owned;    // message thread
+    std::array<Side, maxDecks> sides{};
+    juce::OwnedArray<SlotSource> slotSources;
+
+    float crossfade{ 0.5f };
+
+    AudioProfiler* profiler{ nullptr };
+    std::atomic<double> outputLatency{ 0.0 };
+
+    // last device settings, new decks are prepared with these before going live
+    std::atomic<int> preparedBlockSize{ 0 };
+    std::atomic<double> preparedSampleRate{ 0.0 };
+
+    // removed decks wait here until the block they might be in has finished
+    struct Retired
+    {
+        std::unique_ptr<DJAudioPlayer> deck;
+        juce::uint32 block;
+    };
+    std::vector<Retired> retired;
+    std::atomic<juce::uint32> blockCount{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeckEngine)
+};
@@ -17,10 +17,9 @@
 // waveform, vinyls, knobs, buttons, pads
 // connects to DJAudioPlayer
 DeckGUI::DeckGUI(DJAudioPlayer* _player,
-                juce::AudioFormatManager& formatManagerToUse,
-                juce::AudioThumbnailCache& cacheToUse) 
+                WaveformCache& cacheToUse) 
                 : player(_player),
-                  waveformDisplay(formatManagerToUse, cacheToUse),
+                  waveformDisplay(cacheToUse),
                   vinyl(_player, 33.333)
 {
 
@@ -37,11 +36,13 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
     bool okStop = stopButton.setImagesFromBaseName("stop");
     bool okLoad = loadButton.setImagesFromBaseName("load");
     bool okClear = clearButton.setImagesFromBaseName("clear");
+    bool okSave = saveButton.setImagesFromBaseName("save");
 
     addAndMakeVisible(playButton);
     addAndMakeVisible(stopButton);
     addAndMakeVisible(loadButton);
     addAndMakeVisible(clearButton);
+    addAndMakeVisible(saveButton);
 
 
     // vertical sliders
@@ -66,6 +67,7 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
     stopButton.addListener(this);
     loadButton.addListener(this);
     clearButton.addListener(this);
+    saveButton.addListener(this);
 
     volSlider.addListener(this);
     speedSlider.addListener(this);
@@ -91,6 +93,23 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
     vinylSelect.addListener(this);
     scanVinylAssets();
 
+    // keylock
+    addAndMakeVisible(keylockSelect);
+    keylockSelect.addItem("Keylock off", 1);
+    keylockSelect.addItem("Keylock fast", 2);
+    keylockSelect.addItem("Keylock HQ", 3);
+    keylockSelect.setSelectedId(1, juce::dontSendNotification);
+    keylockSelect.addListener(this);
+
+    // delay mode
+    addAndMakeVisible(delayModeSelect);
+    delayModeSelect.addItem("Echo sync", 1);
+    delayModeSelect.addItem("Ping-pong sync", 2);
+    delayModeSelect.addItem("Echo free", 3);
+    delayModeSelect.addItem("Ping-pong free", 4);
+    delayModeSelect.setSelectedId(1, juce::dontSendNotification);
+    delayModeSelect.addListener(this);
+
     // listen for player load events
     if (player != nullptr)
     {
@@ -144,6 +163,29 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
     delayLabel.setInterceptsMouseClicks(false, false);
     addAndMakeVisible(delayLabel);
 
+    // fx activity readout
+    fxStatsLabel.setJustificationType(juce::Justification::centred);
+    fxStatsLabel.setFont(juce::Font(12.0f));
+    fxStatsLabel.setInterceptsMouseClicks(false, false);
+    addAndMakeVisible(fxStatsLabel);
+
+    // spectrum, pre fx to start with
+    if (player != nullptr)
+    {
+        spectrum.setTap(&player->getPreFxTap());
+        spectrum.setCaption("pre");
+    }
+
+    spectrum.onClick = [this]()
+        {
+            if (player == nullptr) return;
+
+            spectrumPostFx = !spectrumPostFx;
+            spectrum.setTap(spectrumPostFx ? &player->getPostFxTap() : &player->getPreFxTap());
+            spectrum.setCaption(spectrumPostFx ? "post" : "pre");
+        };
+    addAndMakeVisible(spectrum);
+
     // knob functionality
     // reverb
     reverbKnob.onValueChange = [this](int step)
@@ -206,6 +248,13 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
 
 
 
+    // zoomed waveform, drawn from the overview's pyramid once it is ready
+    waveformDisplay.onPyramidChanged = [this](std::shared_ptr<const WaveformPyramid> pyramid)
+        {
+            scrollingWaveform.setPyramid(std::move(pyramid));
+        };
+    addAndMakeVisible(scrollingWaveform);
+
     // 500 milliseconds: half a second
     startTimer(500);
 
@@ -226,6 +275,16 @@ void DeckGUI::paint (juce::Graphics& g)
     g.fillAll(Theme::panelBg);
     g.setColour(Theme::panelOutline());
     g.drawRect(getLocalBounds(), 1);
+
+    // buffer health, turns red when the decoder is falling behind
+    if (!bufferHealthArea.isEmpty())
+    {
+        g.setColour(juce::Colours::black.withAlpha(0.35f));
+        g.fillRect(bufferHealthArea);
+
+        g.setColour(bufferHealth < 0.25f ? juce::Colours::red.withAlpha(0.85f) : Theme::accent);
+        g.fillRect(bufferHealthArea.withWidth(juce::roundToInt(bufferHealthArea.getWidth() * bufferHealth)));
+    }
 }
 
 
@@ -242,10 +301,16 @@ void DeckGUI::resized()
     auto btnRow = r.removeFromBottom(btnRowH);
     const int btnSz = btnRowH;
 
-    // Waveform on top
-    const int waveH = juce::jmax(48, juce::roundToInt(getHeight() * 0.14f));
+    // zoomed waveform on top, whole track overview under it
+    const int scrollH = juce::jmax(48, juce::roundToInt(getHeight() * 0.12f));
+    scrollingWaveform.setBounds(r.removeFromTop(scrollH));
+
+    const int waveH = juce::jmax(32, juce::roundToInt(getHeight() * 0.08f));
     waveformDisplay.setBounds(r.removeFromTop(waveH));
 
+    // thin buffer health strip
+    bufferHealthArea = r.removeFromTop(3);
+
     // position slider
     const int labelW = 50;
     const int posRowH = 20;
@@ -255,9 +320,18 @@ void DeckGUI::resized()
         posSlider.setBounds(row);
     }
 
-    // vinyl dropdown
+    // vinyl, keylock and delay dropdowns
     const int dropH = 24;
-    vinylSelect.setBounds(r.removeFromTop(dropH).reduced(2));
+    {
+        auto row = r.removeFromTop(dropH);
+        const int quarter = row.getWidth() / 4;
+        delayModeSelect.setBounds(row.removeFromRight(quarter).reduced(2));
+        keylockSelect.setBounds(row.removeFromRight(quarter).reduced(2));
+        vinylSelect.setBounds(row.reduced(2));
+    }
+
+    // fx activity readout
+    fxStatsLabel.setBounds(r.removeFromTop(14));
 
     // vinyl area with knobs
     auto vinylArea = r.removeFromTop(juce::roundToInt(getHeight() * 0.55f)).reduced(6);
@@ -374,6 +448,14 @@ void DeckGUI::resized()
     loadButton.setBounds(btnRow.removeFromLeft(btnSz));
     btnRow.removeFromLeft(knobGap);
     clearButton.setBounds(btnRow.removeFromLeft(btnSz));
+
+    // export sits apart on the right
+    saveButton.setBounds(btnRow.removeFromRight(btnSz));
+
+    // spectrum fills the gap between them
+    btnRow.removeFromRight(knobGap);
+    btnRow.removeFromLeft(knobGap);
+    spectrum.setBounds(btnRow.reduced(0, 4));
 }
 
 
@@ -386,6 +468,10 @@ void DeckGUI::buttonClicked(juce::Button* button)
     {
         if (playlist) playlist->clearAll(); 
     }
+    if (button == &saveButton)
+    {
+        if (onExportRequested) onExportRequested();
+    }
     if (button == &loadButton) 
     {
         auto flags = juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles | juce::FileBrowserComponent::canSelectMultipleItems;
@@ -453,9 +539,58 @@ void DeckGUI::filesDropped(const juce::StringArray& files, int x, int y)
 }
 
 
+void DeckGUI::updatePlayhead()
+{
+    if (player == nullptr) return;
+
+    // extrapolated to this frame, in line with what is heard
+    const double seconds = player->getPlayhead().getSecondsNow();
+    const double length = player->getTrackLengthSeconds();
+    const double relative = length > 0.0 ? juce::jlimit(0.0, 1.0, seconds / length) : 0.0;
+
+    // both only repaint what moved
+    waveformDisplay.setPositionRelative(relative);
+    scrollingWaveform.setPlayheadSeconds(seconds);
+
+    // follows playback unless it is being dragged, and only once it would move a pixel
+    if (!posSlider.isMouseButtonDown()
+        && std::abs(posSlider.getValue() - relative) * posSlider.getWidth() >= 1.0)
+        posSlider.setValue(relative, juce::dontSendNotification);
+}
+
 void DeckGUI::timerCallback()
 {
-    waveformDisplay.setPositionRelative(player->getPositionRelative());
+    // only repaint the strip when the fill level moved
+    const float health = player->getBufferHealth();
+    if (std::abs(health - bufferHealth) > 0.01f)
+    {
+        bufferHealth = health;
+        repaint(bufferHealthArea);
+    }
+
+    updateFxStats();
+}
+
+void DeckGUI::updateFxStats()
+{
+    if (player == nullptr) return;
+
+    const auto& fx = player->getEffects();
+    const char* names[EffectsDeck::numStages] = { "cho", "dly", "rev", "cmp" };
+
+    // e.g. "cho - | dly tail | rev on | cmp -   idle 64%"
+    juce::StringArray parts;
+    for (int s = 0; s < EffectsDeck::numStages; ++s)
+    {
+        const auto state = fx.getStageState(s);
+        parts.add(juce::String(names[s]) + (state == EffectsDeck::StageState::active ? " on"
+                                          : state == EffectsDeck::StageState::tail ? " tail" : " -"));
+    }
+
+    const juce::String text = parts.joinIntoString(" | ")
+                            + "   idle " + juce::String(juce::roundToInt(fx.getCpuSaving() * 100.0f)) + "%";
+
+    fxStatsLabel.setText(text, juce::dontSendNotification);
 }
 
 
@@ -561,4 +696,18 @@ void DeckGUI::comboBoxChanged(juce::ComboBox* box)
         const int idx = vinylSelect.getSelectedId() - 1;
         setVinylFromIndex(idx);
     }
+
+    if (box == &keylockSelect && player != nullptr)
+    {
+        // ids follow TimeStretcher::Mode
+        player->setKeylock((TimeStretcher::Mode)(keylockSelect.getSelectedId() - 1));
+    }
+
+    if (box == &delayModeSelect && player != nullptr)
+    {
+        // 1, 2 synced, 3, 4 free, odd ids stereo
+        const int idx = delayModeSelect.getSelectedId() - 1;
+        player->setDelayMode(idx % 2 == 0 ? StereoDelay::Mode::stereo : StereoDelay::Mode::pingPong);
+        player->setDelaySync(idx < 2);
+    }
 }
\ No newline at end of file
@@ -3,10 +3,12 @@
 #include <JuceHeader.h>
 #include "DJAudioPlayer.h"
 #include "WaveformDisplay.h"
+#include "ScrollingWaveform.h"
 #include "PixelButton.h"
 #include "VinylSpinner.h"
 #include "PixelKnob.h"
 #include "PixelPad.h"
+#include "SpectrumBars.h"
 
 
 // avoid circular include errors
@@ -25,8 +27,7 @@ class DeckGUI  : public juce::Component,
 {
 public:
     DeckGUI(DJAudioPlayer* player, 
-            juce::AudioFormatManager& formatManagerToUse,
-            juce::AudioThumbnailCache& cacheToUse
+            WaveformCache& cacheToUse
         );
     ~DeckGUI() override;
 
@@ -64,6 +65,9 @@ public:
     // pad triggered
     std::function<void(const juce::String&)> onPadTriggered;
 
+    // save button, MainComponent renders the whole mix to a file
+    std::function<void()> onExportRequested;
+
 
 private:
     // sliders
@@ -77,6 +81,17 @@ private:
     // waveform display component
     WaveformDisplay waveformDisplay;
 
+    // zoomed in around the playhead, shares the overview's pyramid
+    ScrollingWaveform scrollingWaveform;
+
+    // both waveforms follow the playhead every frame
+    void updatePlayhead();
+    juce::VBlankAttachment vblank{ this, [this] { updatePlayhead(); } };
+
+    // read-ahead fill level strip under the waveform
+    juce::Rectangle<int> bufferHealthArea;
+    float bufferHealth{ 1.0f };
+
     // file chooser
     juce::FileChooser fChooser{ "Select a file..." };
 
@@ -98,6 +113,12 @@ private:
     // vinyl per deck
     VinylSpinner vinyl;                
     juce::ComboBox vinylSelect;        
+
+    // keylock: off / fast (wsola) / hq (phase vocoder)
+    juce::ComboBox keylockSelect;
+
+    // delay: stereo / ping-pong, tempo synced or free
+    juce::ComboBox delayModeSelect;
     juce::StringArray vinylNames;
     juce::Array<juce::File> vinylFiles;
 
@@ -119,6 +140,14 @@ private:
     // knob labels
     juce::Label reverbLabel, chorusLabel, compressionLabel, delayLabel;
 
+    // which fx stages are running and what skipping the rest saves
+    juce::Label fxStatsLabel;
+    void updateFxStats();
+
+    // deck spectrum, click to switch between before and after the fx
+    SpectrumBars spectrum{ 16 };
+    bool spectrumPostFx{ false };
+
     // pads
     PixelPad scratchPad;
     PixelPad vinylGlitchPad;
@@ -0,0 +1,33 @@
+/*
+  ==============================================================================
+
+    DeckStream.h
+    Created: 17 Oct 2026 4:41:52pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// a deck's track as the audio thread sees it
+// either decoded ahead on the i/o thread (ReadAheadSource)
+// or read straight out of a memory mapped file (MappedTrackSource)
+class DeckStream : public juce::PositionableAudioSource
+{
+public:
+    ~DeckStream() override = default;
+
+    // get the first window ready, only before the stream is shared with other threads
+    virtual void prime() = 0;
+
+    // 0..1 how much of the window ahead of the playhead is ready
+    virtual float getBufferHealth() const = 0;
+
+    // blocks that had to be padded with silence
+    virtual int getUnderrunCount() const = 0;
+
+    bool isLooping() const override { return false; }
+};
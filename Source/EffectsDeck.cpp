@@ -19,17 +19,27 @@
 
 void EffectsDeck::prepare(double sampleRate, int maxBlockSize, int numChannels)
 {
+    fs = sampleRate;
+
+    // stage timings, live or offline
+    AudioProfiler::calibrate();
+
     juce::dsp::ProcessSpec spec{ sampleRate,
                                   (juce::uint32)maxBlockSize,
                                   (juce::uint32)numChannels };
     reverb.prepare(spec);
+    reverbWet.setSize(numChannels, juce::jmax(16, maxBlockSize));
+
+    // everything starts idle
+    for (int s = 0; s < numStages; ++s)
+        setState(s, StageState::bypassed);
 
     // reverb defaults
     params.roomSize = 0.35f;
     params.damping = 0.25f;
     params.width = 1.00f;
     params.wetLevel = 0.0f;  // start fully dry
-    params.dryLevel = 1.0f;
+    params.dryLevel = 0.0f;  // dry signal bypasses the reverb
     params.freezeMode = 0.0f;
 
     reverb.setParameters(params);
@@ -38,15 +48,8 @@ void EffectsDeck::prepare(double sampleRate, int maxBlockSize, int numChannels)
     chorus.prepare(spec);
     setChorusAmount(0.0f);
 
-    // delay 
-    const int maxDelaySamples = (int)std::ceil(sampleRate * 2.0);
-    delay = std::make_unique<DL>(maxDelaySamples);
-
-    // prepare with mono (1 channel)
-    juce::dsp::ProcessSpec monoSpec{ sampleRate, (juce::uint32)maxBlockSize, 1u };                
-    delay->prepare(monoSpec);
-
-    delay->reset();
+    // delay, up to 2 seconds (a beat at 30 bpm)
+    delay.prepare(sampleRate, maxBlockSize, 2.0);
     setDelayAmount(0.0f);
 
     // compression
@@ -59,58 +62,113 @@ void EffectsDeck::reset()
     reverb.reset();
     chorus.reset();
     compressor.reset();
-
-    if (delay) delay->reset();
+    delay.reset();
 }
 
 void EffectsDeck::process(juce::AudioBuffer<float>& buffer)
 {
     juce::dsp::AudioBlock<float> block(buffer);
     juce::dsp::ProcessContextReplacing<float> ctx(block);
+    const int nSmps = buffer.getNumSamples();
 
     // chorus before reverb
-    if (chorusMix > 0.0f)
+    if (stages[chorusStage].state != StageState::bypassed)
+    {
+        const auto start = AudioProfiler::now();
         chorus.process(ctx);
+        timeStage(chorusStage, start);
+
+        // mix has ramped back to dry
+        if (stages[chorusStage].state == StageState::tail && (chorusTailLeft -= nSmps) <= 0)
+            setState(chorusStage, StageState::bypassed);
+    }
 
     // delay
-    if (delay && delayMix > 0.0f)
+    if (stages[delayStage].state != StageState::bypassed)
+    {
+        const auto start = AudioProfiler::now();
+        processDelay(buffer);
+        timeStage(delayStage, start);
+    }
+
+    // reverb
+    if (stages[reverbStage].state != StageState::bypassed)
     {
-        const int nCh = buffer.getNumChannels();
-        const int nSmps = buffer.getNumSamples();
+        const auto start = AudioProfiler::now();
+        processReverb(buffer);
+        timeStage(reverbStage, start);
+    }
 
-        const float timeSamples = (float)(delayTimeMs * 0.001 * fs);
-        delay->setDelay(timeSamples);
+    // compression, ratio 1 at amount 0 so there is nothing to do
+    if (stages[compressorStage].state != StageState::bypassed)
+    {
+        const auto start = AudioProfiler::now();
+        compressor.process(ctx);
+        timeStage(compressorStage, start);
+    }
+}
 
-        for (int i = 0; i < nSmps; ++i)
-        {
-            const float inL = (nCh > 0) ? buffer.getSample(0, i) : 0.0f;
-            const float inR = (nCh > 1) ? buffer.getSample(1, i) : 0.0f;
+void EffectsDeck::processDelay(juce::AudioBuffer<float>& buffer)
+{
+    const int nSmps = buffer.getNumSamples();
 
-            // mono 
-            const float monoIn = 0.5f * (inL + inR);
+    // loudest echo heard or written back this block
+    const float peak = delay.process(buffer, 0, nSmps);
 
-            // read delayed sample & write with feedback
-            const float dl = delay->popSample(0);
-            delay->pushSample(0, monoIn + dl * delayFeedback);
+    if (stages[delayStage].state != StageState::tail) return;
 
-            // mix delayed signal back to both channels
-            const float outL = inL * (1.0f - delayMix) + dl * delayMix;
-            const float outR = inR * (1.0f - delayMix) + dl * delayMix;
+    delayQuietSamples = peak < tailThreshold ? delayQuietSamples + nSmps : 0;
 
-            if (nCh > 0) buffer.setSample(0, i, outL);
-            if (nCh > 1) buffer.setSample(1, i, outR);
-        }
+    // the whole line has to be quiet, not just what came out this block
+    if (delayQuietSamples > delay.getDelaySeconds() * fs)
+    {
+        delay.reset();
+        setState(delayStage, StageState::bypassed);
     }
+}
 
-    // reverb
-    if (params.wetLevel > 0.0f)
+void EffectsDeck::processReverb(juce::AudioBuffer<float>& buffer)
+{
+    const bool feeding = stages[reverbStage].state == StageState::active;
+    const int nCh = juce::jmin(buffer.getNumChannels(), reverbWet.getNumChannels());
+    const int nSmps = buffer.getNumSamples();
+
+    float peak = 0.0f;
+    int done = 0;
+
+    while (done < nSmps)
     {
-        reverb.setParameters(params);
-        reverb.process(ctx);
+        const int num = juce::jmin(reverbWet.getNumSamples(), nSmps - done);
+
+        // the tail runs on silence
+        for (int ch = 0; ch < nCh; ++ch)
+        {
+            if (feeding) reverbWet.copyFrom(ch, 0, buffer, ch, done, num);
+            else         reverbWet.clear(ch, 0, num);
+        }
+
+        auto wetBlock = juce::dsp::AudioBlock<float>(reverbWet).getSubsetChannelBlock(0, (size_t)nCh).getSubBlock(0, (size_t)num);
+        reverb.process(juce::dsp::ProcessContextReplacing<float>(wetBlock));
+
+        for (int ch = 0; ch < nCh; ++ch)
+        {
+            buffer.addFrom(ch, done, reverbWet, ch, 0, num);
+            peak = juce::jmax(peak, reverbWet.getMagnitude(ch, 0, num));
+        }
+
+        done += num;
     }
 
-    // compression
-    compressor.process(ctx);
+    if (feeding) return;
+
+    reverbQuietSamples = peak < tailThreshold ? reverbQuietSamples + nSmps : 0;
+
+    // a little hold so one quiet block between comb echoes does not end it
+    if (reverbQuietSamples > (int)(0.1 * fs))
+    {
+        reverb.reset();
+        setState(reverbStage, StageState::bypassed);
+    }
 }
 
 
@@ -119,19 +177,48 @@ void EffectsDeck::setReverbAmount(float wet01)
 {
     wet01 = juce::jlimit(0.0f, 1.0f, wet01);
 
+    // back to 0: stop feeding it and let the room ring out
+    if (wet01 <= 0.0f)
+    {
+        if (stages[reverbStage].state == StageState::active)
+        {
+            reverbQuietSamples = 0;
+            setState(reverbStage, StageState::tail);
+        }
+        return;
+    }
+
     // reverb parameters
     params.roomSize = 0.60f + 0.40f * wet01;   
     params.damping = 0.10f + 0.30f * wet01;   
     params.wetLevel = 0.50f + 0.50f * wet01;   
-    params.dryLevel = 1.0f;
+    params.dryLevel = 0.0f;
+
+    // juce's reverb smooths its own gains and damping
+    reverb.setParameters(params);
 
+    if (stages[reverbStage].state == StageState::bypassed)
+        reverb.reset();
+
+    setState(reverbStage, StageState::active);
 }
 
 // setc chorus amount
 void EffectsDeck::setChorusAmount(float amt01)
 {
     amt01 = juce::jlimit(0.0f, 1.0f, amt01);
-    chorusMix = amt01;
+
+    // back to 0: ramp to dry, then stop
+    if (amt01 <= 0.0f)
+    {
+        if (stages[chorusStage].state == StageState::active)
+        {
+            chorus.setMix(0.0f);
+            chorusTailLeft = (int)(0.1 * fs);
+            setState(chorusStage, StageState::tail);
+        }
+        return;
+    }
 
     // gentle range to avoid distortion 
     const float rateHz = 0.15f + 0.95f * amt01;   
@@ -145,6 +232,11 @@ void EffectsDeck::setChorusAmount(float amt01)
     chorus.setCentreDelay(centreDelay);
     chorus.setFeedback(feedback);
     chorus.setMix(mix);
+
+    if (stages[chorusStage].state == StageState::bypassed)
+        chorus.reset();
+
+    setState(chorusStage, StageState::active);
 }
 
 
@@ -161,6 +253,18 @@ void EffectsDeck::setCompressionAmount(float amt01)
     compressor.setRatio(ratio);
     compressor.setAttack(5.0f);
     compressor.setRelease(50.0f);
+
+    // ratio 1 is a no-op, skip it
+    if (amt01 <= 0.0f)
+    {
+        setState(compressorStage, StageState::bypassed);
+        return;
+    }
+
+    if (stages[compressorStage].state == StageState::bypassed)
+        compressor.reset();
+
+    setState(compressorStage, StageState::active);
 }
 
 // stes delay amount
@@ -168,8 +272,109 @@ void EffectsDeck::setDelayAmount(float amt01)
 {
     amt01 = juce::jlimit(0.0f, 1.0f, amt01);
 
-    // ranges for simple echo
-    delayTimeMs = 90.0f + 360.0f * amt01;
-    delayMix = 0.00f + 0.55f * amt01;
-    delayFeedback = 0.00f + 0.45f * amt01;
+    // back to 0: keep the echoes at their level, stop sending new audio in
+    if (amt01 <= 0.0f)
+    {
+        if (stages[delayStage].state == StageState::active)
+        {
+            delay.setSend(0.0f);
+            delayQuietSamples = 0;
+            setState(delayStage, StageState::tail);
+        }
+        return;
+    }
+
+    delayAmount = amt01;
+    updateDelayTime();
+
+    // coming back from idle: clear line, gains fade in from 0, time snaps
+    if (stages[delayStage].state == StageState::bypassed)
+        delay.reset();
+
+    delay.setMix(0.00f + 0.55f * amt01);
+    delay.setFeedback(0.00f + 0.45f * amt01);
+    delay.setSend(1.0f);
+
+    setState(delayStage, StageState::active);
+}
+
+void EffectsDeck::setDelaySync(bool shouldSync)
+{
+    delaySync = shouldSync;
+    updateDelayTime();
+}
+
+void EffectsDeck::setDelayTempo(double bpm)
+{
+    delayBpm = bpm;
+    if (delaySync) updateDelayTime();
+}
+
+void EffectsDeck::updateDelayTime()
+{
+    if (delaySync && delayBpm > 0.0)
+    {
+        // 7 knob steps, 1..6 pick a division
+        static constexpr double beats[] = { 0.25, 1.0 / 3.0, 0.5, 2.0 / 3.0, 0.75, 1.0 };
+        const int idx = juce::jlimit(0, 5, juce::roundToInt(delayAmount * 6.0f) - 1);
+        delay.setDelaySeconds(beats[idx] * 60.0 / delayBpm);
+    }
+    else
+    {
+        // ranges for simple echo
+        delay.setDelaySeconds((90.0 + 360.0 * delayAmount) * 0.001);
+    }
+}
+
+
+// activity
+void EffectsDeck::setState(int stage, StageState newState)
+{
+    auto& s = stages[(size_t)stage];
+    s.state = newState;
+    s.publishedState.store((int)newState, std::memory_order_relaxed);
+}
+
+void EffectsDeck::timeStage(int stage, juce::int64 startTicks)
+{
+    // same order as the profiler's deck stages
+    static_assert(AudioProfiler::compressorStage - AudioProfiler::chorusStage == compressorStage - chorusStage, "stage order");
+
+    const juce::int64 elapsed = AudioProfiler::now() - startTicks;
+    const double micros = AudioProfiler::ticksToSeconds(elapsed) * 1.0e6;
+
+    if (profiler != nullptr)
+        profiler->record(AudioProfiler::getDeckStage(profilerDeck, AudioProfiler::chorusStage + stage), elapsed);
+
+    // running average over roughly the last 20 blocks
+    auto& s = stages[(size_t)stage];
+    s.cost += 0.05f * ((float)micros - s.cost);
+    s.publishedCost.store(s.cost, std::memory_order_relaxed);
+}
+
+EffectsDeck::StageState EffectsDeck::getStageState(int stage) const
+{
+    return (StageState)stages[(size_t)stage].publishedState.load(std::memory_order_relaxed);
+}
+
+float EffectsDeck::getStageCostMicros(int stage) const
+{
+    return stages[(size_t)stage].publishedCost.load(std::memory_order_relaxed);
+}
+
+float EffectsDeck::getCpuSaving() const
+{
+    // stages that never ran have no cost yet and count for nothing
+    float total = 0.0f, skipped = 0.0f;
+
+    for (int s = 0; s < numStages; ++s)
+    {
+        const float cost = getStageCostMicros(s);
+        total += cost;
+
+        if (getStageState(s) == StageState::bypassed)
+            skipped += cost;
+    }
+
+    return total > 0.0f ? skipped / total : 0.0f;
 }
\ No newline at end of file
@@ -13,6 +13,8 @@
 #include <JuceHeader.h>
 // signal processing
 #include <juce_dsp/juce_dsp.h>
+#include "StereoDelay.h"
+#include "AudioProfiler.h"
 
 
 class EffectsDeck  : public juce::Component
@@ -25,6 +27,7 @@ public:
     // https://docs.juce.com/master/classReverb.html
     
     // call from player
+    // setters run on the audio thread between blocks, only when a knob actually moved
     void prepare(double sampleRate, int maxBlockSize, int numChannels);
     void reset();
     void process(juce::AudioBuffer<float>& buffer);
@@ -41,27 +44,88 @@ public:
     // delay
     void setDelayAmount(float amt01);
 
+    // echoes stay on one side or bounce between them
+    void setDelayMode(StereoDelay::Mode mode) { delay.setMode(mode); }
+
+    // synced: the knob picks 1/4 .. 1 beat at the track tempo, otherwise 90..450ms
+    void setDelaySync(bool shouldSync);
+
+    // current track bpm, speed included, 0 when unknown
+    void setDelayTempo(double bpm);
+
+    // -- ACTIVITY --
+    // bypassed: skipped, costs nothing
+    // active: knob above 0
+    // tail: knob back at 0, input muted, runs until its echoes / reverb die away
+    enum class StageState { bypassed = 0, active, tail };
+    enum Stage { chorusStage = 0, delayStage, reverbStage, compressorStage, numStages };
+
+    // any thread, for the fx readout
+    StageState getStageState(int stage) const;
+
+    // average time one block spends in the stage while it runs, microseconds
+    float getStageCostMicros(int stage) const;
+
+    // 0..1 share of the all-stages-on cost skipped right now
+    float getCpuSaving() const;
+
+    // stage timings also go to the profiler under this deck, before playback starts
+    void setProfiler(AudioProfiler* p, int deck) { profiler = p; profilerDeck = deck; }
+
 private:
+    // audio thread state, mirrored into atomics for the gui
+    struct StageInfo
+    {
+        StageState state{ StageState::bypassed };
+        float cost{ 0.0f };
+        std::atomic<int> publishedState{ 0 };
+        std::atomic<float> publishedCost{ 0.0f };
+    };
+
+    void setState(int stage, StageState newState);
+
+    // adds the time since startTicks to the stage's running average
+    void timeStage(int stage, juce::int64 startTicks);
+
+    void processDelay(juce::AudioBuffer<float>& buffer);
+    void processReverb(juce::AudioBuffer<float>& buffer);
+
+    // a tail is over once it stays below -80 dB
+    static constexpr float tailThreshold = 1.0e-4f;
+
+    std::array<StageInfo, numStages> stages;
+
+    AudioProfiler* profiler{ nullptr };
+    int profilerDeck{ 0 };
+
     // effects settings
 
     // reverb
     juce::dsp::Reverb reverb;
     juce::dsp::Reverb::Parameters params{};
 
+    // wet only, added on top of the dry signal so the tail can outlive the input
+    juce::AudioBuffer<float> reverbWet;
+    int reverbQuietSamples{ 0 };
+
     // chorus
     juce::dsp::Chorus<float> chorus;
-    float chorusMix{ 0.0f };
+    int chorusTailLeft{ 0 };
 
     // compression
     juce::dsp::Compressor<float> compressor;
 
     // delay
-    using DL = juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear>;
-    std::unique_ptr<DL> delay;   // mono line
+    StereoDelay delay;
     double fs{ 44100.0 };
-    float  delayTimeMs{ 0.0f };  
-    float  delayFeedback{ 0.0f };  
-    float  delayMix{ 0.0f };
+
+    // last non zero knob amount, still sets the time while the tail plays
+    float delayAmount{ 0.0f };
+    bool delaySync{ true };
+    double delayBpm{ 0.0 };
+    int delayQuietSamples{ 0 };
+
+    void updateDelayTime();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EffectsDeck)
 };
@@ -9,6 +9,8 @@
 
 #include <JuceHeader.h>
 #include "MainComponent.h"
+#include "CommandLineRender.h"
+#include "Benchmarks.h"
 
 
 //==============================================================================
@@ -27,6 +29,23 @@ public:
     {
         // This method is where you should put your application's initialisation code..
 
+        // headless render for batch jobs: no window, no audio device
+        const juce::ArgumentList args(getApplicationName(), commandLine);
+        if (CommandLineRender::isRequested(args))
+        {
+            setApplicationReturnValue(CommandLineRender::run(args));
+            quit();
+            return;
+        }
+
+        // audio thread micro-benchmarks, also headless
+        if (Benchmarks::isRequested(args))
+        {
+            setApplicationReturnValue(Benchmarks::run(args));
+            quit();
+            return;
+        }
+
         mainWindow.reset (new MainWindow (getApplicationName()));
     }
 
@@ -1,5 +1,56 @@
 ﻿#include "MainComponent.h"
 
+namespace
+{
+    // runs the offline render with a progress bar, deletes itself when done
+    class ExportWindow : public juce::ThreadWithProgressWindow
+    {
+    public:
+        ExportWindow(juce::AudioFormatManager& formatManager, MixSettings settingsToRender)
+            : juce::ThreadWithProgressWindow("Exporting mix...", true, true),
+              renderer(formatManager),
+              settings(std::move(settingsToRender))
+        {
+        }
+
+        void run() override
+        {
+            result = renderer.render(settings, [this](double p)
+                {
+                    setProgress(p);
+                    return !threadShouldExit();
+                });
+        }
+
+        void threadComplete(bool userPressedCancel) override
+        {
+            if (!userPressedCancel)
+            {
+                if (result.wasOk())
+                {
+                    juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon, "Export finished",
+                        settings.outputFile.getFileName() + "\n"
+                        + juce::String(renderer.getRenderedSeconds(), 1) + " s of audio in "
+                        + juce::String(renderer.getWallSeconds(), 1) + " s ("
+                        + juce::String(renderer.getRealtimeFactor(), 1) + "x realtime)");
+                }
+                else
+                {
+                    juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Export failed",
+                        result.getErrorMessage());
+                }
+            }
+
+            delete this;
+        }
+
+    private:
+        OfflineRenderer renderer;
+        MixSettings settings;
+        juce::Result result{ juce::Result::ok() };
+    };
+}
+
 MainComponent::MainComponent()
 {
     // set custom theme
@@ -11,6 +62,12 @@ MainComponent::MainComponent()
 
     setSize(1600, 900);
 
+    // decks and pads render in parallel, added before audio starts
+    // every deck slot is an input (input n is slot n), switched on while it holds a deck
+    for (int slot = 0; slot < DeckEngine::maxDecks; ++slot)
+        deckMixer.addInputSource(&deckEngine.getSlotSource(slot), false);
+    deckMixer.addInputSource(&timedSampleBank);
+
 
 
     // permissions to open input channels request
@@ -26,47 +83,69 @@ MainComponent::MainComponent()
         setAudioChannels(2, 2);
     }
 
-    addAndMakeVisible(deckGUI1);
-    addAndMakeVisible(deckGUI2);
-
-    addAndMakeVisible(playlistComponent1);
-    addAndMakeVisible(playlistComponent2);
-
     // add mixing strip
     addAndMakeVisible(mixerStrip);
 
-    // set each components playlist
-    deckGUI1.setPlaylist(&playlistComponent1);
-    deckGUI2.setPlaylist(&playlistComponent2);
-
-    // connect to DeckGUI pads
-    deckGUI1.onPadTriggered = [this](const juce::String& id) { triggerPad(id); };
-    deckGUI2.onPadTriggered = [this](const juce::String& id) { triggerPad(id); };
-
     // crossfader
-    mixerStrip.onCrossfadeChanged = [this](float x) { applyCrossfade(x); };
+    mixerStrip.onCrossfadeChanged = [this](float x) { deckEngine.setCrossfade(x); };
     mixerStrip.onSnapToDeck = [this](bool toB)
         {
-            applyCrossfade(toB ? 1.0f : 0.0f);
+            deckEngine.setCrossfade(toB ? 1.0f : 0.0f);
+        };
+
+    // deck count and sides
+    mixerStrip.onAddDeck = [this]()
+        {
+            // alternate sides so new decks land where there is room
+            addDeck(deckViews.size() % 2 == 0 ? DeckEngine::Side::a : DeckEngine::Side::b);
+        };
+    mixerStrip.onRemoveDeck = [this]() { removeLastDeck(); };
+    mixerStrip.onDeckSideChanged = [this](int deck, int side)
+        {
+            deckEngine.setSide(deckViews[(size_t)deck]->slot, (DeckEngine::Side)side);
+            resized();
         };
+    mixerStrip.onChoosePadFolder = [this]() { choosePadFolder(); };
 
     // bars visualization
+    playlistGapViz.setTap(&masterTap);
+    spectrumWorker.addTap(&masterTap);
     addAndMakeVisible(playlistGapViz);
 
+    // profiler, reads the device's xrun counter on the message thread
+    profilerOverlay.getXRunCount = [this]()
+        {
+            auto* device = deviceManager.getCurrentAudioDevice();
+            return device != nullptr ? device->getXRunCount() : 0;
+        };
+    addChildComponent(profilerOverlay);
+    setWantsKeyboardFocus(true);
+
 
     formatManager.registerBasicFormats();
 
-    // load user library
-    playlistComponent1.loadLibrary();
-    playlistComponent2.loadLibrary();
+    // start decoding thread for deck streaming
+    deckIOThread.startThread();
+    padIOThread.startThread();
+
+    // pad folder picked last time, if it is still there
+    const juce::File padFolder(getPadFolderFile().loadFileAsString().trim());
+    if (padFolder.isDirectory())
+        sampleBank.setSampleFolder(padFolder);
 
+    // every deck reports to the profiler under its slot
+    deckEngine.setProfiler(&profiler);
+
+    // two decks to start with, loads their libraries
+    addDeck(DeckEngine::Side::a);
+    addDeck(DeckEngine::Side::b);
 }
 
 MainComponent::~MainComponent()
 {
     // save library
-    playlistComponent1.saveLibrary();
-    playlistComponent2.saveLibrary();
+    for (auto& view : deckViews)
+        view->playlist->saveLibrary();
     // shuts down the audio device and clears the audio source.
     shutdownAudio();
     // remove theme
@@ -76,42 +155,45 @@ MainComponent::~MainComponent()
 //==============================================================================
 void MainComponent::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
 {
-    player1.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    player2.prepareToPlay(samplesPerBlockExpected, sampleRate);
-
-    // init mixer
-    mixerSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    // init mixer, prepares the decks and the sample bank
+    deckMixer.prepareToPlay(samplesPerBlockExpected, sampleRate);
 
-    // set up mixer
-    mixerSource.addInputSource(&player1, false);
-    mixerSource.addInputSource(&player2, false);
+    // freq bars, cleared by the spectrum worker rather than under its feet
+    masterTap.reset();
 
-    // add samples input source
-    mixerSource.addInputSource(&sampleBank, false);
-    sampleBank.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    profiler.prepare(sampleRate);
 
-    // freq bars
-    playlistGapViz.prepare(sampleRate);
+    // playheads show what is heard: the device's own latency plus the buffer being filled
+    if (auto* device = deviceManager.getCurrentAudioDevice())
+        deckEngine.setOutputLatency((device->getOutputLatencyInSamples() + samplesPerBlockExpected) / sampleRate);
 }
 
 void MainComponent::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) 
 {
-    mixerSource.getNextAudioBlock(bufferToFill);
+    const auto callbackStart = AudioProfiler::now();
+
+    // decks removed before this point are no longer rendered
+    deckEngine.beginBlock();
+
+    {
+        const AudioProfiler::ScopedTimer timer(&profiler, AudioProfiler::mixerStage);
+        deckMixer.getNextAudioBlock(bufferToFill);
+    }
+
+    // freq bars
+    {
+        const AudioProfiler::ScopedTimer timer(&profiler, AudioProfiler::spectrumStage);
+        masterTap.push(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+    }
 
-    // freq bars]mixerSource.getNextAudioBlock(bufferToFill);
-    playlistGapViz.pushAudioBlock(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+    profiler.recordCallback(AudioProfiler::now() - callbackStart, bufferToFill.numSamples);
 }
 
 
 void MainComponent::releaseResources()
 {
-    player1.releaseResources();
-    player2.releaseResources();
-
-    // release samples resources
-    sampleBank.releaseResources();
-
-    mixerSource.releaseResources();
+    // releases decks and samples too
+    deckMixer.releaseResources();
 }
 
 void MainComponent::paint (juce::Graphics& g)
@@ -133,9 +215,7 @@ void MainComponent::resized()
     auto center = decksArea.removeFromLeft(mixW);
     auto right = decksArea;
 
-    deckGUI1.setBounds(left);
     mixerStrip.setBounds(center.reduced(8));
-    deckGUI2.setBounds(right);
 
     // playlists
     auto playlistsArea = r;
@@ -144,41 +224,205 @@ void MainComponent::resized()
     auto gap = playlistsArea.removeFromLeft(mixW); // empty gap same as mixer width
     auto rightPl = playlistsArea;
 
-    playlistComponent1.setBounds(leftPl);
-    playlistComponent2.setBounds(rightPl);
+    // side B decks go right of the mixer, A and thru decks left
+    std::vector<DeckView*> leftDecks, rightDecks;
+    for (auto& view : deckViews)
+    {
+        const bool onRight = deckEngine.getSide(view->slot) == DeckEngine::Side::b;
+        (onRight ? rightDecks : leftDecks).push_back(view.get());
+    }
+
+    // decks on one side share its width, each above its playlist
+    auto layoutSide = [](std::vector<DeckView*>& views, juce::Rectangle<int> deckArea, juce::Rectangle<int> plArea)
+        {
+            const int count = (int)views.size();
+            for (int i = 0; i < count; ++i)
+            {
+                const int remaining = count - i;
+                views[(size_t)i]->gui->setBounds(deckArea.removeFromLeft(deckArea.getWidth() / remaining));
+                views[(size_t)i]->playlist->setBounds(plArea.removeFromLeft(plArea.getWidth() / remaining));
+            }
+        };
+
+    layoutSide(leftDecks, left, leftPl);
+    layoutSide(rightDecks, right, rightPl);
 
     // bars
     playlistGapViz.setBounds(gap.reduced(6));
+
+    // over the middle of the decks
+    profilerOverlay.setBounds(getLocalBounds().withSizeKeepingCentre(520, 560));
 }
 
-void MainComponent::applyCrossfade(float x)
+bool MainComponent::keyPressed (const juce::KeyPress& key)
 {
-    x = juce::jlimit(0.0f, 1.0f, x);
+    if (key == juce::KeyPress('p', juce::ModifierKeys::commandModifier, 0))
+    {
+        profilerOverlay.setVisible(!profilerOverlay.isVisible());
+        profilerOverlay.toFront(false);
+        return true;
+    }
+
+    return false;
+}
 
-    // hard endpoints to guarantee isolation on snaps
-    if (x <= 0.0f + 1e-4f)
+void MainComponent::addDeck(DeckEngine::Side side)
+{
+    const int slot = deckEngine.addDeck(side);
+    if (slot < 0) return;
+
+    // the deck is live, its slot starts rendering from the next block
+    deckMixer.setInputActive(slot, true);
+
+    auto* player = deckEngine.getDeck(slot);
+    spectrumWorker.addTap(&player->getPreFxTap());
+    spectrumWorker.addTap(&player->getPostFxTap());
+
+    auto view = std::make_unique<DeckView>();
+    view->slot = slot;
+    view->gui = std::make_unique<DeckGUI>(player, waveformCache);
+
+    // library file per slot, decks 1 and 2 keep their old playlists
+    view->playlist = std::make_unique<PlaylistComponent>(*player, *view->gui, formatManager, juce::String(slot + 1));
+
+    // set the deck's playlist
+    view->gui->setPlaylist(view->playlist.get());
+
+    // connect to DeckGUI pads
+    view->gui->onPadTriggered = [this](const juce::String& id) { triggerPad(id); };
+
+    // every deck's save button exports the whole mix
+    view->gui->onExportRequested = [this]() { exportMix(); };
+
+    addAndMakeVisible(*view->gui);
+    addAndMakeVisible(*view->playlist);
+
+    // load user library
+    view->playlist->loadLibrary();
+
+    deckViews.push_back(std::move(view));
+
+    updateDeckSides();
+    resized();
+}
+
+void MainComponent::removeLastDeck()
+{
+    // always keep one deck
+    if (deckViews.size() <= 1) return;
+
+    const int slot = deckViews.back()->slot;
+    deckViews.back()->playlist->saveLibrary();
+
+    // gui first, it still points at the player
+    deckViews.pop_back();
+
+    auto* player = deckEngine.getDeck(slot);
+    spectrumWorker.removeTap(&player->getPreFxTap());
+    spectrumWorker.removeTap(&player->getPostFxTap());
+
+    deckMixer.setInputActive(slot, false);
+    deckEngine.removeDeck(slot);
+
+    updateDeckSides();
+    resized();
+}
+
+void MainComponent::updateDeckSides()
+{
+    juce::Array<int> sides;
+    for (auto& view : deckViews)
+        sides.add((int)deckEngine.getSide(view->slot));
+
+    mixerStrip.setDeckSides(sides);
+}
+
+void MainComponent::exportMix()
+{
+    // every loaded deck, from where it is now, with its current controls
+    // only the ones playing now start, the rest stay cued
+    MixSettings mix;
+
+    for (auto& view : deckViews)
     {
-        player1.setGain(1.0f);
-        player2.setGain(0.0f);
+        auto* deck = deckEngine.getDeck(view->slot);
+        if (deck == nullptr || deck->getTrackLengthSeconds() <= 0.0) continue;
+
+        MixSettings::Deck d;
+        d.url = deck->getCurrentURL();
+        d.startSeconds = deck->getPositionSeconds();
+        d.bpm = deck->getTrackBpm();
+        d.settings = deck->getSettings();
+        d.side = deckEngine.getSide(view->slot);
+        d.playing = deck->isPlaying();
+        mix.decks.push_back(d);
+    }
+
+    if (mix.decks.empty())
+    {
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon, "Export", "Load a track first.");
         return;
     }
-    if (x >= 1.0f - 1e-4f)
+
+    if (std::none_of(mix.decks.begin(), mix.decks.end(), [](const auto& d) { return d.playing; }))
     {
-        player1.setGain(0.0f);
-        player2.setGain(1.0f);
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon, "Export", "Start a deck first, only playing decks are exported.");
         return;
     }
 
-    // equal power crossfade
-    const float theta = x * juce::MathConstants<float>::halfPi;
-    const float gA = std::cos(theta) * std::cos(theta);
-    const float gB = std::sin(theta) * std::sin(theta);
+    mix.crossfade = deckEngine.getCrossfade();
+    mix.padFolder = sampleBank.getSampleFolder();
+
+    // same rate as the device, so the export sounds like what was heard
+    if (auto* device = deviceManager.getCurrentAudioDevice())
+        mix.sampleRate = device->getCurrentSampleRate();
+
+    const auto defaultFile = juce::File::getSpecialLocation(juce::File::userMusicDirectory).getChildFile("PixelSpin mix.wav");
+    exportChooser = std::make_unique<juce::FileChooser>("Export mix as WAV or FLAC...", defaultFile, "*.wav;*.flac");
 
-    player1.setGain(gA);
-    player2.setGain(gB);
+    const auto flags = juce::FileBrowserComponent::saveMode
+                     | juce::FileBrowserComponent::canSelectFiles
+                     | juce::FileBrowserComponent::warnAboutOverwriting;
+
+    exportChooser->launchAsync(flags, [this, mix](const juce::FileChooser& fc) mutable
+        {
+            auto file = fc.getResult();
+            if (file == juce::File{}) return;
+
+            if (file.hasFileExtension("flac"))
+                mix.format = MixSettings::Format::flac;
+            else if (!file.hasFileExtension("wav"))
+                file = file.withFileExtension("wav");
+
+            mix.outputFile = file;
+
+            // owns itself, freed in threadComplete
+            (new ExportWindow(formatManager, std::move(mix)))->launchThread();
+        });
 }
 
+void MainComponent::choosePadFolder()
+{
+    padFolderChooser = std::make_unique<juce::FileChooser>("Choose a folder of pad samples...", sampleBank.getSampleFolder());
 
+    const auto flags = juce::FileBrowserComponent::openMode
+                     | juce::FileBrowserComponent::canSelectDirectories;
 
+    padFolderChooser->launchAsync(flags, [this](const juce::FileChooser& fc)
+        {
+            const auto folder = fc.getResult();
+            if (!folder.isDirectory()) return;
 
+            // the current kit keeps playing until the new one has loaded
+            sampleBank.setSampleFolder(folder);
+            getPadFolderFile().replaceWithText(folder.getFullPathName());
+        });
+}
 
+juce::File MainComponent::getPadFolderFile()
+{
+    auto dir = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory).getChildFile(juce::String(ProjectInfo::projectName));
+
+    dir.createDirectory();
+    return dir.getChildFile("pad_folder.txt");
+}
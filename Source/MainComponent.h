@@ -2,12 +2,18 @@
 
 #include <JuceHeader.h>
 #include "DJAudioPlayer.h"
+#include "DeckEngine.h"
 #include "DeckGUI.h"
 #include "PlaylistComponent.h"
 #include "VinylSpinner.h"
 #include "CustomLookAndFeel.h"
 #include "SampleAudioSource.h"
+#include "SpectrumAnalyser.h"
 #include "SpectrumBars.h"
+#include "ParallelMixer.h"
+#include "OfflineRenderer.h"
+#include "AudioProfiler.h"
+#include "ProfilerOverlay.h"
 
 
 class MainComponent  : public juce::AudioAppComponent
@@ -25,6 +31,7 @@ public:
     //==============================================================================
     void paint (juce::Graphics& g) override;
     void resized() override;
+    bool keyPressed (const juce::KeyPress& key) override;
 
 
     // theme
@@ -35,31 +42,64 @@ public:
 
 
 private:
-    juce::AudioFormatManager formatManager;
-    juce::AudioThumbnailCache thumbCache{ 100 };
+    // stage timings of the audio callback, declared before everything that reports to it
+    AudioProfiler profiler;
 
+    juce::AudioFormatManager formatManager;
 
-    DJAudioPlayer player1{ formatManager };
-    DJAudioPlayer player2{ formatManager };
+    // waveforms of every track ever loaded, kept on disk
+    WaveformCache waveformCache{ formatManager };
 
-    DeckGUI deckGUI1{ &player1, formatManager, thumbCache };
-    DeckGUI deckGUI2{ &player2, formatManager, thumbCache };
+    // background decoding for all decks
+    juce::TimeSliceThread deckIOThread{ "Deck read-ahead" };
 
-    juce::MixerAudioSource mixerSource;
+    // every deck and its crossfader side
+    DeckEngine deckEngine{ formatManager, deckIOThread };
 
-    PlaylistComponent playlistComponent1{ player1, deckGUI1, formatManager, "1"};
-    PlaylistComponent playlistComponent2{ player2, deckGUI2, formatManager, "2"};
+    // renders the decks and pads on a worker per core
+    ParallelMixer deckMixer;
 
-    SampleAudioSource sampleBank;
+    // long samples stream on their own thread, a busy kit never holds up the decks
+    juce::TimeSliceThread padIOThread{ "Pad streaming" };
+    SampleAudioSource sampleBank{ &padIOThread };
+    AudioProfiler::TimedSource timedSampleBank{ sampleBank, profiler, AudioProfiler::padsStage };
 
     // mixing
     MixerStrip mixerStrip;         
 
-    // crossfade helper
-    void applyCrossfade(float x);  
-
-    // bars
-    SpectrumBars playlistGapViz{ 10 /*1024*/, 16 /*bars*/ };
+    // one deck on screen, its controls and its playlist
+    struct DeckView
+    {
+        int slot{ -1 };
+        std::unique_ptr<DeckGUI> gui;
+        std::unique_ptr<PlaylistComponent> playlist; // declared last, it refers to gui
+    };
+    std::vector<std::unique_ptr<DeckView>> deckViews;
+
+    // deck helpers, message thread
+    void addDeck(DeckEngine::Side side);
+    void removeLastDeck();
+    void updateDeckSides();
+
+    // save button: capture the decks, pick a file, render in the background
+    void exportMix();
+    std::unique_ptr<juce::FileChooser> exportChooser;
+
+    // pads button: pick a sample folder, remembered for next time
+    void choosePadFolder();
+    static juce::File getPadFolderFile();
+    std::unique_ptr<juce::FileChooser> padFolderChooser;
+
+    // bars, the master output
+    SpectrumTap masterTap{ 10 /*1024*/ };
+    SpectrumBars playlistGapViz{ 16 /*bars*/ };
+
+    // analyses the master and every deck's taps
+    // declared after everything owning a tap so it stops first
+    SpectrumWorker spectrumWorker;
+
+    // ctrl/cmd+p, hidden to start with
+    ProfilerOverlay profilerOverlay{ profiler };
 
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainComponent)
@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    MappedTrackSource.cpp
+    Created: 17 Oct 2026 4:41:52pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "MappedTrackSource.h"
+
+// https://docs.juce.com/master/classMemoryMappedAudioFormatReader.html <-- documentation used
+
+MappedTrackSource::MappedTrackSource(juce::MemoryMappedAudioFormatReader* r,
+                                     juce::TimeSliceThread& ioThread,
+                                     double prefaultSeconds)
+    : reader(r),
+      thread(ioThread),
+      totalLength(r->lengthInSamples),
+      samplesPerPage(juce::jmax(1, 4096 / juce::jmax(1, (int)r->numChannels * (int)r->bitsPerSample / 8))),
+      aheadSamples((juce::int64)(prefaultSeconds * r->sampleRate)),
+      behindSamples((juce::int64)(0.5 * r->sampleRate))
+{
+}
+
+MappedTrackSource::~MappedTrackSource()
+{
+    thread.removeTimeSliceClient(this);
+}
+
+void MappedTrackSource::prime()
+{
+    while (prefaultNext()) {}
+}
+
+void MappedTrackSource::prepareToPlay(int, double)
+{
+    if (!isPrepared)
+    {
+        thread.addTimeSliceClient(this);
+        isPrepared = true;
+    }
+}
+
+void MappedTrackSource::releaseResources()
+{
+    thread.removeTimeSliceClient(this);
+    isPrepared = false;
+}
+
+// audio thread: convert straight from the mapping into the output buffer
+void MappedTrackSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+{
+    const int num = info.numSamples;
+    juce::int64 pos = readPosition.load(std::memory_order_acquire);
+
+    // past the end of the track is silence
+    const int available = (int)juce::jlimit((juce::int64)0, (juce::int64)num, totalLength - pos);
+
+    if (available > 0)
+        reader->read(info.buffer, info.startSample, available, pos, true, true);
+
+    if (available < num)
+        info.buffer->clear(info.startSample + available, num - available);
+
+    // advance unless a seek landed meanwhile
+    readPosition.compare_exchange_strong(pos, pos + num, std::memory_order_release);
+}
+
+void MappedTrackSource::setNextReadPosition(juce::int64 newPosition)
+{
+    readPosition.store(newPosition, std::memory_order_release);
+}
+
+juce::int64 MappedTrackSource::getNextReadPosition() const
+{
+    return readPosition.load(std::memory_order_relaxed);
+}
+
+juce::int64 MappedTrackSource::getTotalLength() const
+{
+    return totalLength;
+}
+
+float MappedTrackSource::getBufferHealth() const
+{
+    const auto pos = readPosition.load(std::memory_order_relaxed);
+    const auto end = faultEnd.load(std::memory_order_relaxed);
+
+    const auto wanted = juce::jmin(aheadSamples, totalLength - pos);
+    if (wanted <= 0) return 1.0f;
+
+    return juce::jlimit(0.0f, 1.0f, (float)(end - pos) / (float)wanted);
+}
+
+int MappedTrackSource::useTimeSlice()
+{
+    return prefaultNext() ? 1 : 5;
+}
+
+// i/o thread: read one byte per page so the os maps them in before playback gets there
+bool MappedTrackSource::prefaultNext()
+{
+    const auto playPos = readPosition.load(std::memory_order_acquire);
+    auto end = faultEnd.load(std::memory_order_relaxed);
+
+    // seek outside the resident window: start again a little behind the new playhead
+    if (playPos < faultStart || playPos > end)
+    {
+        faultStart = juce::jmax((juce::int64)0, playPos - behindSamples);
+        end = faultStart;
+        faultEnd.store(end, std::memory_order_release);
+    }
+    else
+    {
+        // slide the window along with playback
+        faultStart = juce::jmax(faultStart, playPos - behindSamples);
+    }
+
+    const auto target = juce::jmin(playPos + aheadSamples, totalLength);
+    if (end >= target) return false;
+
+    const auto stop = juce::jmin(target, end + (juce::int64)samplesPerPage * pagesPerSlice);
+
+    for (auto s = end; s < stop; s += samplesPerPage)
+        reader->touchSample(s);
+
+    faultEnd.store(stop, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    MappedTrackSource.h
+    Created: 17 Oct 2026 4:41:52pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DeckStream.h"
+
+// plays uncompressed WAV/AIFF straight out of a memory mapped file
+// no decode thread and no ring buffer: the audio thread converts samples from the
+// mapping into the output, and the i/o thread only touches pages around the
+// playhead so the callback never waits on a page fault
+class MappedTrackSource : public DeckStream,
+                          private juce::TimeSliceClient
+{
+public:
+    // takes ownership of an already mapped reader
+    MappedTrackSource(juce::MemoryMappedAudioFormatReader* reader,
+                      juce::TimeSliceThread& ioThread,
+                      double prefaultSeconds);
+    ~MappedTrackSource() override;
+
+    // fault in the first window
+    void prime() override;
+
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    // seeks are free, the mapping covers the whole file
+    void setNextReadPosition(juce::int64 newPosition) override;
+    juce::int64 getNextReadPosition() const override;
+    juce::int64 getTotalLength() const override;
+
+    // 0..1 how much of the window ahead of the playhead is resident
+    float getBufferHealth() const override;
+
+    // reading from the mapping cannot run dry
+    int getUnderrunCount() const override { return 0; }
+
+private:
+    int useTimeSlice() override;
+
+    // touch the next run of pages, false if the window is already resident
+    bool prefaultNext();
+
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader;
+    juce::TimeSliceThread& thread;
+
+    const juce::int64 totalLength;
+
+    // samples per memory page, so one touch per page is enough
+    const int samplesPerPage;
+
+    // how far ahead of and behind the playhead to keep resident
+    const juce::int64 aheadSamples;
+    const juce::int64 behindSamples;
+
+    std::atomic<juce::int64> readPosition{ 0 };
+
+    // pages are resident from faultStart up to faultEnd, i/o thread only
+    juce::int64 faultStart{ 0 };
+    std::atomic<juce::int64> faultEnd{ 0 };
+
+    bool isPrepared{ false };
+
+    // pages touched per time slice
+    static constexpr int pagesPerSlice = 64;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MappedTrackSource)
+};
@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    MixSettings.cpp
+    Created: 18 Oct 2026 1:07:44am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "MixSettings.h"
+
+// https://docs.juce.com/master/classJSON.html <-- documentation used
+
+namespace
+{
+    // number property clamped to a range, fallback when missing
+    double getNumber(const juce::var& object, const char* name, double fallback, double lo, double hi)
+    {
+        const auto value = object.getProperty(name, fallback);
+        return juce::jlimit(lo, hi, (double)value);
+    }
+
+    juce::File resolve(const juce::String& path, const juce::File& baseDir)
+    {
+        return juce::File::isAbsolutePath(path) ? juce::File(path) : baseDir.getChildFile(path);
+    }
+}
+
+juce::Result MixSettings::fromJSON(const juce::var& json, const juce::File& baseDir, MixSettings& result)
+{
+    if (!json.isObject())
+        return juce::Result::fail("Mix settings must be a JSON object");
+
+    MixSettings mix;
+
+    // output
+    const auto output = json.getProperty("output", {}).toString();
+    if (output.isNotEmpty())
+    {
+        mix.outputFile = resolve(output, baseDir);
+        mix.format = mix.outputFile.hasFileExtension("flac") ? Format::flac : Format::wav;
+    }
+
+    mix.sampleRate = getNumber(json, "sampleRate", mix.sampleRate, 8000.0, 384000.0);
+    mix.lengthSeconds = getNumber(json, "length", 0.0, 0.0, 24.0 * 60.0 * 60.0);
+    mix.tailSeconds = getNumber(json, "tail", mix.tailSeconds, 0.0, 60.0);
+    mix.crossfade = (float)getNumber(json, "crossfade", mix.crossfade, 0.0, 1.0);
+
+    mix.bitDepth = (int)json.getProperty("bitDepth", mix.bitDepth);
+    if (mix.bitDepth != 16 && mix.bitDepth != 24 && mix.bitDepth != 32)
+        return juce::Result::fail("bitDepth must be 16, 24 or 32");
+
+    // decks
+    if (auto* decks = json.getProperty("decks", {}).getArray())
+    {
+        for (const auto& d : *decks)
+        {
+            Deck deck;
+
+            const auto file = resolve(d.getProperty("file", {}).toString(), baseDir);
+            if (!file.existsAsFile())
+                return juce::Result::fail("Track not found: " + file.getFullPathName());
+
+            deck.url = juce::URL(file);
+            deck.startSeconds = getNumber(d, "start", 0.0, 0.0, 24.0 * 60.0 * 60.0);
+            deck.bpm = getNumber(d, "bpm", 0.0, 0.0, 400.0);
+            deck.playing = (bool)d.getProperty("playing", true);
+
+            const auto side = d.getProperty("side", "A").toString().toLowerCase();
+            deck.side = side == "b" ? DeckEngine::Side::b
+                      : side == "thru" ? DeckEngine::Side::thru
+                      : DeckEngine::Side::a;
+
+            auto& s = deck.settings;
+            s.gain = (float)getNumber(d, "gain", s.gain, 0.0, 1.0);
+            s.speed = (float)getNumber(d, "speed", s.speed, 0.0, 2.0);
+            s.reverb = (float)getNumber(d, "reverb", s.reverb, 0.0, 1.0);
+            s.chorus = (float)getNumber(d, "chorus", s.chorus, 0.0, 1.0);
+            s.compression = (float)getNumber(d, "compression", s.compression, 0.0, 1.0);
+            s.delay = (float)getNumber(d, "delay", s.delay, 0.0, 1.0);
+            s.delaySync = (bool)d.getProperty("delaySync", s.delaySync);
+
+            const auto delayMode = d.getProperty("delayMode", "echo").toString().toLowerCase();
+            s.delayMode = delayMode == "pingpong" ? StereoDelay::Mode::pingPong : StereoDelay::Mode::stereo;
+
+            const auto keylock = d.getProperty("keylock", "off").toString().toLowerCase();
+            s.keylock = keylock == "fast" ? TimeStretcher::Mode::wsola
+                      : keylock == "hq" ? TimeStretcher::Mode::phaseVocoder
+                      : TimeStretcher::Mode::off;
+
+            mix.decks.push_back(deck);
+        }
+    }
+
+    if (mix.decks.empty())
+        return juce::Result::fail("No decks in the mix settings");
+
+    // pad hits
+    const auto padFolder = json.getProperty("padFolder", {}).toString();
+    if (padFolder.isNotEmpty())
+    {
+        mix.padFolder = resolve(padFolder, baseDir);
+        if (!mix.padFolder.isDirectory())
+            return juce::Result::fail("Pad folder not found: " + mix.padFolder.getFullPathName());
+    }
+
+    if (auto* pads = json.getProperty("pads", {}).getArray())
+    {
+        for (const auto& p : *pads)
+        {
+            PadHit hit;
+            hit.seconds = getNumber(p, "time", 0.0, 0.0, 24.0 * 60.0 * 60.0);
+            hit.id = p.getProperty("id", {}).toString();
+            hit.gain = (float)getNumber(p, "gain", 1.0, 0.0, 1.0);
+
+            if (hit.id.isNotEmpty())
+                mix.padHits.push_back(hit);
+        }
+    }
+
+    result = std::move(mix);
+    return juce::Result::ok();
+}
@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    MixSettings.h
+    Created: 18 Oct 2026 12:31:15am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DJAudioPlayer.h"
+#include "DeckEngine.h"
+
+// everything the offline renderer needs to play a set without the live decks
+// captured from the decks on the message thread, then handed to the render thread by value
+struct MixSettings
+{
+    struct Deck
+    {
+        juce::URL url;
+        double startSeconds{ 0.0 };
+
+        // 0 estimates it again while loading
+        double bpm{ 0.0 };
+
+        DJAudioPlayer::Settings settings;
+        DeckEngine::Side side{ DeckEngine::Side::a };
+
+        // a stopped deck stays cued at startSeconds and adds nothing but its fx tails
+        bool playing{ true };
+    };
+
+    // one-shot pad hit, seconds from the start of the export
+    struct PadHit
+    {
+        double seconds{ 0.0 };
+        juce::String id;
+        float gain{ 1.0f };
+    };
+
+    enum class Format { wav = 0, flac };
+
+    std::vector<Deck> decks;
+    std::vector<PadHit> padHits;
+
+    // samples the hits play, empty uses the bundled Assets/Samples
+    juce::File padFolder;
+    float crossfade{ 0.5f };
+
+    double sampleRate{ 44100.0 };
+
+    // 0 renders until the last deck runs out, plus the tail
+    double lengthSeconds{ 0.0 };
+
+    // reverb and echoes ringing out after the music stops
+    double tailSeconds{ 2.0 };
+
+    juce::File outputFile;
+    Format format{ Format::wav };
+
+    // 16 or 24, 32 writes float WAV (FLAC tops out at 24)
+    int bitDepth{ 24 };
+
+    // reads a mix description (see CommandLineRender.h for the layout)
+    // relative file names are resolved against baseDir
+    static juce::Result fromJSON(const juce::var& json, const juce::File& baseDir, MixSettings& result);
+};
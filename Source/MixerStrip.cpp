@@ -57,6 +57,45 @@ MixerStrip::MixerStrip()
 
     addAndMakeVisible(btnA);
     addAndMakeVisible(btnB);
+
+    // add / remove decks
+    addDeckButton.onClick = [this]() { if (onAddDeck) onAddDeck(); };
+    removeDeckButton.onClick = [this]() { if (onRemoveDeck) onRemoveDeck(); };
+
+    addAndMakeVisible(addDeckButton);
+    addAndMakeVisible(removeDeckButton);
+
+    // sample folder for the pads
+    padFolderButton.setTooltip("Choose the folder the pads play from, matched by file name");
+    padFolderButton.onClick = [this]() { if (onChoosePadFolder) onChoosePadFolder(); };
+    addAndMakeVisible(padFolderButton);
+}
+
+// rebuild the side selectors, one per deck
+void MixerStrip::setDeckSides(const juce::Array<int>& sides)
+{
+    sideSelects.clear();
+
+    for (int i = 0; i < sides.size(); ++i)
+    {
+        auto* box = sideSelects.add(new juce::ComboBox());
+        const juce::String deck(i + 1);
+
+        box->addItem("Deck " + deck + ": A", 1);
+        box->addItem("Deck " + deck + ": B", 2);
+        box->addItem("Deck " + deck + ": thru", 3);
+        box->setSelectedId(sides[i] + 1, juce::dontSendNotification);
+
+        box->onChange = [this, i, box]()
+            {
+                if (onDeckSideChanged)
+                    onDeckSideChanged(i, box->getSelectedId() - 1);
+            };
+
+        addAndMakeVisible(box);
+    }
+
+    resized();
 }
 
 // setter for crossfade
@@ -76,9 +115,11 @@ void MixerStrip::resized()
     const int btnH = 32;
     const int crossH = 24;
     const int gap = 6;
+    const int rowH = 22;
 
     // total block height
-    const int blockH = titleH + gap + btnH + gap + crossH;
+    const int blockH = titleH + gap + btnH + gap + crossH
+                     + gap + rowH + 2 + rowH + sideSelects.size() * (rowH + 2);
 
     // vertically centered block
     auto block = area.withHeight(blockH).withCentre(area.getCentre());
@@ -103,5 +144,23 @@ void MixerStrip::resized()
     auto crossRow = block.removeFromTop(crossH);
     auto crossW = crossRow.getWidth(); // leave margin
     crossfader.setBounds(crossRow.withWidth(crossW).withCentre(crossRow.getCentre()));
+
+    block.removeFromTop(gap);
+
+    // add / remove row
+    auto deckRow = block.removeFromTop(rowH);
+    addDeckButton.setBounds(deckRow.removeFromLeft(deckRow.getWidth() / 2).reduced(2, 0));
+    removeDeckButton.setBounds(deckRow.reduced(2, 0));
+
+    // pad folder row
+    block.removeFromTop(2);
+    padFolderButton.setBounds(block.removeFromTop(rowH).reduced(2, 0));
+
+    // side selector per deck
+    for (auto* box : sideSelects)
+    {
+        block.removeFromTop(2);
+        box->setBounds(block.removeFromTop(rowH));
+    }
 }
 
@@ -28,6 +28,18 @@ public:
     // snaps playback to deck A or B
     std::function<void(bool)>  onSnapToDeck;       
 
+    // one side selector per deck, in on-screen order
+    // side: 0 = A, 1 = B, 2 = thru
+    void setDeckSides(const juce::Array<int>& sides);
+
+    // deck count and crossfader assignment
+    std::function<void()> onAddDeck;
+    std::function<void()> onRemoveDeck;
+    std::function<void(int deck, int side)> onDeckSideChanged;
+
+    // pick the folder the pads play from
+    std::function<void()> onChoosePadFolder;
+
     void resized() override;
 
 private:
@@ -35,5 +47,10 @@ private:
     juce::Slider crossfader;
     PixelButton btnA, btnB;
 
+    // deck management
+    juce::TextButton addDeckButton{ "+" }, removeDeckButton{ "-" };
+    juce::TextButton padFolderButton{ "pads..." };
+    juce::OwnedArray<juce::ComboBox> sideSelects;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MixerStrip)
 };
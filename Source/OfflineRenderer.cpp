@@ -0,0 +1,226 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Created: 18 Oct 2026 12:31:15am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "OfflineRenderer.h"
+#include "ParallelMixer.h"
+#include "SampleAudioSource.h"
+
+// https://docs.juce.com/master/classAudioFormatWriter.html <-- documentation used
+
+namespace
+{
+    // triangular (tpdf) dither of +-1 lsb at the output bit depth, nothing for float files
+    class TpdfDither
+    {
+    public:
+        TpdfDither(int bitDepth, int maxBlock)
+            : lsb(bitDepth < 32 ? 1.0f / (float)(1 << (bitDepth - 1)) : 0.0f),
+              first((size_t)maxBlock), second((size_t)maxBlock)
+        {
+            // fixed seeds, the same mix always exports to the same file
+            for (size_t k = 0; k < state.size(); ++k)
+                state[k] = 0x9e3779b9u * (juce::uint32)(k + 1);
+        }
+
+        void process(juce::AudioBuffer<float>& buffer, int num)
+        {
+            if (lsb == 0.0f) return;
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            {
+                // difference of two uniforms is triangular over -1..1
+                fillUniform(first.data(), num);
+                fillUniform(second.data(), num);
+                juce::FloatVectorOperations::subtract(first.data(), second.data(), num);
+                juce::FloatVectorOperations::addWithMultiply(buffer.getWritePointer(ch), first.data(), lsb, num);
+            }
+        }
+
+    private:
+        // 0..1, eight generators side by side so the loop vectorises
+        void fillUniform(float* dest, int num)
+        {
+            constexpr float scale = 1.0f / 16777216.0f;
+            int i = 0;
+
+            for (; i + 8 <= num; i += 8)
+                for (int k = 0; k < 8; ++k)
+                {
+                    state[(size_t)k] = state[(size_t)k] * 1664525u + 1013904223u;
+                    dest[i + k] = (float)(int)(state[(size_t)k] >> 8) * scale;
+                }
+
+            for (; i < num; ++i)
+            {
+                state[0] = state[0] * 1664525u + 1013904223u;
+                dest[i] = (float)(int)(state[0] >> 8) * scale;
+            }
+        }
+
+        const float lsb;
+        std::vector<float> first, second;
+        std::array<juce::uint32, 8> state{};
+    };
+}
+
+OfflineRenderer::OfflineRenderer(juce::AudioFormatManager& fmt)
+    : formatManager(fmt)
+{
+}
+
+juce::Result OfflineRenderer::render(const MixSettings& settings, const std::function<bool(double)>& progress)
+{
+    renderedSeconds = wallSeconds = 0.0;
+
+    if (settings.decks.empty())
+        return juce::Result::fail("Nothing to export, load a track first");
+
+    const double rate = settings.sampleRate;
+
+    // own i/o thread for mapped files, compressed ones decode inline
+    juce::TimeSliceThread ioThread{ "Export read-ahead" };
+    ioThread.startThread();
+
+    // same chain as live: decks and pads summed by the parallel mixer
+    ParallelMixer mixer{ false };
+    SampleAudioSource pads;
+    std::vector<std::unique_ptr<DJAudioPlayer>> decks;
+    double longest = 0.0;
+
+    for (const auto& d : settings.decks)
+    {
+        auto deck = std::make_unique<DJAudioPlayer>(formatManager, ioThread);
+        deck->applySettings(d.settings);
+        deck->setCrossfadeGain(DeckEngine::getSideGain(d.side, settings.crossfade));
+
+        const double length = deck->loadURLNow(d.url, d.startSeconds, d.bpm, d.playing);
+        if (length <= 0.0)
+            return juce::Result::fail("Couldn't open " + d.url.getFileName());
+
+        // a stopped speed slider would never finish, treat it as the slowest keylock tempo
+        // stopped decks don't set the length
+        const double speed = juce::jmax((double)TimeStretcher::minTempo, (double)d.settings.speed);
+        if (d.playing)
+            longest = juce::jmax(longest, (length - d.startSeconds) / speed);
+
+        mixer.addInputSource(deck.get());
+        decks.push_back(std::move(deck));
+    }
+
+    mixer.addInputSource(&pads);
+
+    // the kit the live pads were playing
+    if (settings.padFolder.isDirectory())
+        pads.setSampleFolder(settings.padFolder);
+
+    const double seconds = settings.lengthSeconds > 0.0
+                         ? settings.lengthSeconds
+                         : juce::jmin(maxSeconds, longest + settings.tailSeconds);
+    const auto total = (juce::int64)(seconds * rate);
+
+    // writer
+    std::unique_ptr<juce::AudioFormat> format;
+    int bits = settings.bitDepth;
+
+    if (settings.format == MixSettings::Format::flac)
+    {
+        format = std::make_unique<juce::FlacAudioFormat>();
+        bits = juce::jmin(24, bits);
+    }
+    else
+    {
+        format = std::make_unique<juce::WavAudioFormat>();
+    }
+
+    settings.outputFile.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream(settings.outputFile.createOutputStream());
+    if (stream == nullptr)
+        return juce::Result::fail("Couldn't write to " + settings.outputFile.getFullPathName());
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), rate, 2, bits, {}, 0));
+    if (writer == nullptr)
+    {
+        stream.reset();
+        settings.outputFile.deleteFile();
+        return juce::Result::fail(juce::String(bits) + " bit " + format->getFormatName() + " isn't supported at "
+                                  + juce::String(rate) + " Hz");
+    }
+
+    // the writer owns it now
+    stream.release();
+
+    // pad hits in time order, in output samples
+    auto hits = settings.padHits;
+    std::sort(hits.begin(), hits.end(), [](const auto& a, const auto& b) { return a.seconds < b.seconds; });
+    size_t nextHit = 0;
+    auto hitSample = [&](size_t i) { return (juce::int64)(hits[i].seconds * rate); };
+
+    mixer.prepareToPlay(blockSize, rate);
+
+    // pads converted to the export rate before the first hit
+    pads.waitForConversion();
+
+    juce::AudioBuffer<float> block(2, blockSize);
+    TpdfDither dither(bits, blockSize);
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    juce::int64 done = 0;
+    juce::String error;
+
+    while (done < total)
+    {
+        while (nextHit < hits.size() && hitSample(nextHit) <= done)
+        {
+            pads.trigger(hits[nextHit].id, hits[nextHit].gain);
+            ++nextHit;
+        }
+
+        // stop short of the next hit so it lands on its sample
+        juce::int64 end = juce::jmin(done + blockSize, total);
+        if (nextHit < hits.size())
+            end = juce::jmin(end, hitSample(nextHit));
+
+        const int num = (int)(end - done);
+
+        mixer.getNextAudioBlock(juce::AudioSourceChannelInfo(&block, 0, num));
+        dither.process(block, num);
+
+        if (!writer->writeFromAudioSampleBuffer(block, 0, num))
+        {
+            error = "Writing " + settings.outputFile.getFileName() + " failed, is the disk full?";
+            break;
+        }
+
+        done = end;
+
+        if (progress && !progress((double)done / (double)total))
+        {
+            error = "Export cancelled";
+            break;
+        }
+    }
+
+    mixer.releaseResources();
+
+    // flushes and closes the file
+    writer.reset();
+
+    wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    renderedSeconds = (double)done / rate;
+
+    if (error.isNotEmpty())
+    {
+        settings.outputFile.deleteFile();
+        return juce::Result::fail(error);
+    }
+
+    return juce::Result::ok();
+}
@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Created: 18 Oct 2026 12:31:15am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MixSettings.h"
+
+// renders a mix to a file as fast as the cpu allows, no audio device involved
+// builds its own decks, mixer and pads from MixSettings and runs them through the same
+// deck -> fx -> crossfader -> pad chain as the live callback, which it never touches
+class OfflineRenderer
+{
+public:
+    explicit OfflineRenderer(juce::AudioFormatManager& formatManager);
+
+    // blocking, call from a background thread
+    // progress gets 0..1 after every block, returning false cancels and deletes the file
+    juce::Result render(const MixSettings& settings, const std::function<bool(double)>& progress = {});
+
+    // results of the last render
+    double getRenderedSeconds() const { return renderedSeconds; }
+    double getWallSeconds() const { return wallSeconds; }
+
+    // how many times faster than playing it back live
+    double getRealtimeFactor() const { return wallSeconds > 0.0 ? renderedSeconds / wallSeconds : 0.0; }
+
+    static constexpr int blockSize = 1024;
+
+    // longest export when the length comes from the tracks
+    static constexpr double maxSeconds = 4.0 * 60.0 * 60.0;
+
+private:
+    juce::AudioFormatManager& formatManager;
+
+    double renderedSeconds{ 0.0 };
+    double wallSeconds{ 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineRenderer)
+};
@@ -0,0 +1,315 @@
+/*
+  ==============================================================================
+
+    ParallelMixer.cpp
+    Created: 17 Oct 2026 11:22:40pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ParallelMixer.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+#if JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#elif JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#else
+ #include <semaphore.h>
+ #include <cerrno>
+#endif
+
+// https://docs.juce.com/master/classThread.html <-- documentation used (RealtimeOptions)
+
+namespace
+{
+    // cheap wait inside the join spin
+    inline void cpuPause()
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #else
+        std::this_thread::yield();
+       #endif
+    }
+}
+
+ParallelMixer::WakeSemaphore::WakeSemaphore()
+{
+   #if JUCE_MAC || JUCE_IOS
+    handle = (void*)dispatch_semaphore_create(0);
+   #elif JUCE_WINDOWS
+    handle = (void*)CreateSemaphoreW(nullptr, 0, LONG_MAX, nullptr);
+   #else
+    auto* sem = new sem_t;
+    sem_init(sem, 0, 0);
+    handle = sem;
+   #endif
+}
+
+ParallelMixer::WakeSemaphore::~WakeSemaphore()
+{
+   #if JUCE_MAC || JUCE_IOS
+    dispatch_release((dispatch_semaphore_t)handle);
+   #elif JUCE_WINDOWS
+    CloseHandle((HANDLE)handle);
+   #else
+    sem_destroy((sem_t*)handle);
+    delete (sem_t*)handle;
+   #endif
+}
+
+// audio thread: never blocks and never takes a lock
+void ParallelMixer::WakeSemaphore::post()
+{
+   #if JUCE_MAC || JUCE_IOS
+    dispatch_semaphore_signal((dispatch_semaphore_t)handle);
+   #elif JUCE_WINDOWS
+    ReleaseSemaphore((HANDLE)handle, 1, nullptr);
+   #else
+    sem_post((sem_t*)handle);
+   #endif
+}
+
+void ParallelMixer::WakeSemaphore::wait()
+{
+   #if JUCE_MAC || JUCE_IOS
+    dispatch_semaphore_wait((dispatch_semaphore_t)handle, DISPATCH_TIME_FOREVER);
+   #elif JUCE_WINDOWS
+    WaitForSingleObject((HANDLE)handle, INFINITE);
+   #else
+    while (sem_wait((sem_t*)handle) != 0 && errno == EINTR) {}
+   #endif
+}
+
+ParallelMixer::Worker::Worker(ParallelMixer& o, int index)
+    : juce::Thread("Deck render " + juce::String(index + 1)),
+      owner(o)
+{
+}
+
+void ParallelMixer::Worker::run()
+{
+    while (!threadShouldExit())
+    {
+        wake.wait();
+
+        if (threadShouldExit()) return;
+
+        owner.renderJobs();
+    }
+}
+
+ParallelMixer::~ParallelMixer()
+{
+    stopWorkers();
+}
+
+void ParallelMixer::addInputSource(juce::AudioSource* input, bool active)
+{
+    // the set of sources is fixed while audio runs
+    jassert(input != nullptr && workers.isEmpty() && inputs.size() < maxInputs);
+
+    setInputActive(inputs.size(), active);
+    inputs.add(input);
+    activeJobs.resize((size_t)inputs.size());
+}
+
+void ParallelMixer::setInputActive(int index, bool shouldBeActive)
+{
+    jassert(juce::isPositiveAndBelow(index, maxInputs));
+    const auto bit = (juce::uint64)1 << index;
+
+    if (shouldBeActive)
+        activeMask.fetch_or(bit, std::memory_order_relaxed);
+    else
+        activeMask.fetch_and(~bit, std::memory_order_relaxed);
+}
+
+void ParallelMixer::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    stopWorkers();
+
+    maxBlock = juce::jmax(16, samplesPerBlockExpected);
+
+    buffers.clear();
+    for (auto* input : inputs)
+    {
+        input->prepareToPlay(samplesPerBlockExpected, sampleRate);
+        buffers.add(new juce::AudioBuffer<float>(2, maxBlock));
+    }
+
+    // nothing to claim until the first block
+    nextJob.store(0);
+    remaining.store(0);
+
+    startWorkers(samplesPerBlockExpected, sampleRate);
+}
+
+void ParallelMixer::releaseResources()
+{
+    stopWorkers();
+
+    for (auto* input : inputs)
+        input->releaseResources();
+}
+
+void ParallelMixer::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+{
+    // only the active inputs become jobs, an empty slot costs nothing
+    const auto mask = activeMask.load(std::memory_order_relaxed);
+    int numJobs = 0;
+
+    for (int i = 0; i < inputs.size(); ++i)
+        if ((mask >> i) & 1)
+            activeJobs[(size_t)numJobs++] = i;
+
+    if (numJobs == 0)
+    {
+        info.clearActiveBufferRegion();
+        return;
+    }
+
+    auto& out = *info.buffer;
+    int done = 0;
+    int total = 0, renderedHere = 0;
+
+    while (done < info.numSamples)
+    {
+        const int num = juce::jmin(maxBlock, info.numSamples - done);
+
+        // publish the block, then open the job counter
+        // workers only read blockSamples after claiming a job
+        blockSamples = num;
+        remaining.store(numJobs, std::memory_order_relaxed);
+        nextJob.store((juce::uint64)numJobs << 32, std::memory_order_release);
+
+        // a lone source is rendered right here
+        if (numJobs > 1)
+            for (auto* worker : workers)
+                worker->wake.post();
+
+        // render whatever the workers have not claimed yet
+        renderedHere += renderJobs();
+        total += numJobs;
+
+        // join: every claimed source has finished
+        while (remaining.load(std::memory_order_acquire) > 0)
+            cpuPause();
+
+        // sum, decks render stereo: folded to mono on a one channel output, channels past 1 silent
+        if (out.getNumChannels() == 1)
+        {
+            float* dest = out.getWritePointer(0, info.startSample + done);
+            juce::FloatVectorOperations::clear(dest, num);
+
+            for (int j = 0; j < numJobs; ++j)
+            {
+                const auto* buffer = buffers.getUnchecked(activeJobs[(size_t)j]);
+                juce::FloatVectorOperations::addWithMultiply(dest, buffer->getReadPointer(0), 0.5f, num);
+                juce::FloatVectorOperations::addWithMultiply(dest, buffer->getReadPointer(1), 0.5f, num);
+            }
+        }
+
+        else
+        {
+            for (int ch = 0; ch < out.getNumChannels(); ++ch)
+            {
+                float* dest = out.getWritePointer(ch, info.startSample + done);
+
+                if (ch > 1)
+                {
+                    juce::FloatVectorOperations::clear(dest, num);
+                    continue;
+                }
+
+                juce::FloatVectorOperations::copy(dest, buffers.getUnchecked(activeJobs[0])->getReadPointer(ch), num);
+
+                for (int j = 1; j < numJobs; ++j)
+                    juce::FloatVectorOperations::add(dest, buffers.getUnchecked(activeJobs[(size_t)j])->getReadPointer(ch), num);
+            }
+        }
+
+        done += num;
+    }
+
+    // running average over roughly the last 20 blocks
+    const float share = 1.0f - (float)renderedHere / (float)total;
+    shareAverage += 0.05f * (share - shareAverage);
+    parallelShare.store(shareAverage, std::memory_order_relaxed);
+}
+
+int ParallelMixer::renderJobs()
+{
+    juce::ScopedNoDenormals noDenormals;
+    int count = 0;
+
+    for (;;)
+    {
+        const auto claim = nextJob.fetch_add(1, std::memory_order_acq_rel);
+        const int job = (int)(claim & 0xffffffffu);
+        if (job >= (int)(claim >> 32)) break;
+
+        const int input = activeJobs[(size_t)job];
+
+        // exactly this block's length, the fx process whole buffers
+        // shrinking within the prepared size never reallocates
+        auto* buffer = buffers.getUnchecked(input);
+        buffer->setSize(2, blockSamples, false, false, true);
+        inputs.getUnchecked(input)->getNextAudioBlock(juce::AudioSourceChannelInfo(buffer, 0, blockSamples));
+
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+        ++count;
+    }
+
+    return count;
+}
+
+void ParallelMixer::startWorkers(int samplesPerBlock, double sampleRate)
+{
+    // the audio thread renders too, so one source per block needs no help
+    const int cores = juce::SystemStats::getNumCpus();
+    const int count = juce::jlimit(0, juce::jmax(0, cores - 1), inputs.size() - 1);
+
+    const auto options = juce::Thread::RealtimeOptions{}
+                             .withApproximateAudioProcessingTime(samplesPerBlock, sampleRate);
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto* worker = workers.add(new Worker(*this, i));
+
+        if (!realtime)
+        {
+            worker->startThread();
+            continue;
+        }
+
+        // one core each, leaving the first to the device callback (no-op on macOS)
+        worker->setAffinityMask((juce::uint32)1 << ((i + 1) % juce::jmin(cores, 32)));
+
+        if (!worker->startRealtimeThread(options))
+            worker->startThread(juce::Thread::Priority::highest);
+    }
+}
+
+void ParallelMixer::stopWorkers()
+{
+    for (auto* worker : workers)
+    {
+        worker->signalThreadShouldExit();
+        worker->wake.post();
+    }
+
+    for (auto* worker : workers)
+        worker->stopThread(1000);
+
+    workers.clear();
+}
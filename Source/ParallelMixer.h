@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    ParallelMixer.h
+    Created: 17 Oct 2026 11:22:40pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// renders independent sources (decks, sampler) in parallel and sums them
+// replaces juce::MixerAudioSource, which renders one source after another
+// each block: the audio thread wakes the workers, every thread claims sources
+// off an atomic counter, the audio thread spins until the last one is done
+// the audio thread also renders, so a source no worker has claimed yet never waits for one,
+// but a source a worker has claimed is waited for, however long that worker takes
+class ParallelMixer : public juce::AudioSource
+{
+public:
+    // offline renders pass false: plain priority, unpinned, so they never compete with the live callback
+    explicit ParallelMixer(bool realtimeWorkers = true) : realtime(realtimeWorkers) {}
+    ~ParallelMixer() override;
+
+    // message thread, before audio starts; sources are not owned
+    // an inactive input is still prepared and released, but never rendered or summed
+    void addInputSource(juce::AudioSource* input, bool active = true);
+
+    // any thread, from the next block (an empty deck slot, say)
+    void setInputActive(int index, bool shouldBeActive);
+
+    // inputs are tracked in a 64 bit mask
+    static constexpr int maxInputs = 64;
+
+    // prepares every input and (re)starts the workers
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    // worker threads helping the audio thread
+    int getNumWorkers() const { return workers.size(); }
+
+    // 0..1 share of sources rendered off the audio thread, recent blocks
+    float getParallelShare() const { return parallelShare.load(std::memory_order_relaxed); }
+
+private:
+    // counting semaphore whose post never takes a lock (juce::WaitableEvent does),
+    // so the audio thread can wake a worker
+    // sem_t on linux, dispatch_semaphore_t on apple, a win32 semaphore on windows
+    class WakeSemaphore
+    {
+    public:
+        WakeSemaphore();
+        ~WakeSemaphore();
+
+        void post();
+        void wait();
+
+    private:
+        void* handle{ nullptr };
+
+        JUCE_DECLARE_NON_COPYABLE(WakeSemaphore)
+    };
+
+    // one realtime thread, pinned to its own core where the os allows it
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(ParallelMixer& owner, int index);
+        void run() override;
+
+        // one post per block, a late worker may wake to find nothing left to claim
+        WakeSemaphore wake;
+
+    private:
+        ParallelMixer& owner;
+    };
+
+    // claim and render sources until none are left, returns how many this thread did
+    int renderJobs();
+
+    void startWorkers(int samplesPerBlock, double sampleRate);
+    void stopWorkers();
+
+    juce::Array<juce::AudioSource*> inputs;
+    juce::OwnedArray<juce::AudioBuffer<float>> buffers;
+    juce::OwnedArray<Worker> workers;
+    const bool realtime;
+    int maxBlock{ 0 };
+
+    // bit per input
+    std::atomic<juce::uint64> activeMask{ 0 };
+
+    // current block, written by the audio thread before nextJob is reset
+    // job i renders input activeJobs[i]
+    int blockSamples{ 0 };
+    std::vector<int> activeJobs;
+
+    // next job in the low half, the block's job count in the high half,
+    // so a late worker never pairs an old claim with a new count
+    std::atomic<juce::uint64> nextJob{ 0 };
+    std::atomic<int> remaining{ 0 };
+
+    std::atomic<float> parallelShare{ 0.0f };
+    float shareAverage{ 0.0f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParallelMixer)
+};
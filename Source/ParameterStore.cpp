@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    ParameterStore.cpp
+    Created: 17 Oct 2026 9:14:51pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ParameterStore.h"
+
+// https://en.cppreference.com/w/cpp/atomic/memory_order <-- documentation used
+
+ParameterStore::ParameterStore(std::initializer_list<float> defaults)
+    : numParameters((int)defaults.size())
+{
+    jassert(numParameters <= maxParameters);
+
+    int i = 0;
+    for (float v : defaults)
+    {
+        values[(size_t)i].store(v, std::memory_order_relaxed);
+        snapshot[(size_t)i] = v;
+        ++i;
+    }
+}
+
+void ParameterStore::set(int index, float value)
+{
+    jassert(juce::isPositiveAndBelow(index, numParameters));
+
+    values[(size_t)index].store(value, std::memory_order_relaxed);
+
+    // the value is visible to whoever sees the bit
+    written.fetch_or(bit(index), std::memory_order_release);
+}
+
+float ParameterStore::get(int index) const
+{
+    jassert(juce::isPositiveAndBelow(index, numParameters));
+    return values[(size_t)index].load(std::memory_order_relaxed);
+}
+
+juce::uint32 ParameterStore::update()
+{
+    // one atomic op per block when nothing moved
+    juce::uint32 pending = written.exchange(0, std::memory_order_acquire);
+    juce::uint32 changed = 0;
+
+    while (pending != 0)
+    {
+        const int i = juce::findHighestSetBit(pending);
+        pending &= ~bit(i);
+
+        // a knob set back to where it was is not a change
+        const float v = values[(size_t)i].load(std::memory_order_relaxed);
+        if (v != snapshot[(size_t)i])
+        {
+            snapshot[(size_t)i] = v;
+            changed |= bit(i);
+        }
+    }
+
+    return changed;
+}
@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    ParameterStore.h
+    Created: 17 Oct 2026 9:14:51pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// lock-free control values shared between the message thread and the audio thread
+// front: one atomic per parameter, plus a bit per parameter saying it was written
+// back: the audio thread's own copy, refreshed once per block from the written bits only
+// the audio thread gets back which values really changed, so it only recomputes those
+class ParameterStore
+{
+public:
+    // one bit each in the change mask
+    static constexpr int maxParameters = 32;
+
+    // number of parameters is the number of defaults
+    explicit ParameterStore(std::initializer_list<float> defaults);
+
+    // any thread, never blocks
+    void set(int index, float value);
+
+    // any thread: last value written
+    float get(int index) const;
+
+    // audio thread: pulls in everything written since the last call
+    // returns a mask with bit i set when parameter i now has a different value
+    juce::uint32 update();
+
+    // audio thread: value as of the last update()
+    float operator[](int index) const { return snapshot[(size_t)index]; }
+
+    static constexpr juce::uint32 bit(int index) { return 1u << index; }
+
+private:
+    const int numParameters;
+
+    std::array<std::atomic<float>, maxParameters> values;
+    std::atomic<juce::uint32> written{ 0 };
+
+    std::array<float, maxParameters> snapshot{};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterStore)
+};
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    PlayheadClock.cpp
+    Created: 18 Oct 2026 5:31:44am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PlayheadClock.h"
+
+void PlayheadClock::publish(double newSeconds, double newRate, double outputLatency)
+{
+    const double when = now() + outputLatency;
+
+    // single writer: mark busy, write, mark done
+    const auto seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    seconds.store(newSeconds, std::memory_order_relaxed);
+    rate.store(newRate, std::memory_order_relaxed);
+    heardAt.store(when, std::memory_order_relaxed);
+
+    sequence.store(seq + 2, std::memory_order_release);
+}
+
+PlayheadClock::State PlayheadClock::read() const
+{
+    State state;
+
+    for (;;)
+    {
+        const auto before = sequence.load(std::memory_order_acquire);
+
+        state.seconds = seconds.load(std::memory_order_relaxed);
+        state.rate = rate.load(std::memory_order_relaxed);
+        state.heardAt = heardAt.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // not mid-write and nothing written since, the copy is whole
+        if ((before & 1) == 0 && sequence.load(std::memory_order_relaxed) == before)
+            return state;
+    }
+}
+
+double PlayheadClock::getSecondsNow() const
+{
+    const auto state = read();
+
+    // negative while the block is still on its way to the speakers
+    // capped ahead so a stalled audio thread doesn't run the playhead off
+    const double elapsed = juce::jlimit(-1.0, 0.25, now() - state.heardAt);
+
+    return juce::jmax(0.0, state.seconds + state.rate * elapsed);
+}
@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    PlayheadClock.h
+    Created: 18 Oct 2026 5:31:44am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// where a deck is in its track, as heard through the speakers
+// the audio thread publishes position, rate and the time that block reaches the output
+// once per block behind a seqlock; the ui reads it every frame without locking and
+// extrapolates to the moment it draws
+class PlayheadClock
+{
+public:
+    struct State
+    {
+        double seconds{ 0.0 };     // track position of the block's first sample
+        double rate{ 0.0 };        // track seconds per real second, 0 while stopped
+        double heardAt{ 0.0 };     // when that sample leaves the device, hi-res ms counter in seconds
+    };
+
+    // audio thread, once per block before rendering
+    // outputLatency: device output latency plus one buffer
+    void publish(double seconds, double rate, double outputLatency);
+
+    // any thread, a consistent copy of the last publish
+    State read() const;
+
+    // any thread: position heard right now
+    double getSecondsNow() const;
+
+    static double now() { return juce::Time::getMillisecondCounterHiRes() * 0.001; }
+
+private:
+    // odd while the audio thread is writing
+    std::atomic<juce::uint32> sequence{ 0 };
+
+    // atomics only so torn reads aren't a data race, the sequence decides what is valid
+    std::atomic<double> seconds{ 0.0 };
+    std::atomic<double> rate{ 0.0 };
+    std::atomic<double> heardAt{ 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PlayheadClock)
+};
@@ -200,9 +200,8 @@ void PlaylistComponent::playRow(int row)
     if (row < 0 || row >= (int)tracks.size()) return;
 
     juce::URL url{ tracks[(size_t)row].file }; 
-    player.loadURL(url); // load into transport
+    player.loadURL(url, true); // load in the background, starts playing once ready
     deckGUI.showWaveForm(url); // update ui waveforn
-    player.start(); // start playback
 }
 
 // save user library to json
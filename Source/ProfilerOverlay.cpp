@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    ProfilerOverlay.cpp
+    Created: 18 Oct 2026 2:48:10am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ProfilerOverlay.h"
+
+ProfilerOverlay::ProfilerOverlay(const AudioProfiler& p)
+    : profiler(p),
+      current(std::make_unique<AudioProfiler::Snapshot>(p.getSnapshot())),
+      baseline(std::make_unique<AudioProfiler::Snapshot>(*current))
+{
+    setInterceptsMouseClicks(true, false);
+}
+
+void ProfilerOverlay::visibilityChanged()
+{
+    // nothing to refresh while hidden
+    if (isVisible()) startTimerHz(4);
+    else stopTimer();
+}
+
+void ProfilerOverlay::timerCallback()
+{
+    *current = profiler.getSnapshot();
+    xruns = getXRunCount ? getXRunCount() : 0;
+    repaint();
+}
+
+void ProfilerOverlay::mouseDown(const juce::MouseEvent&)
+{
+    *baseline = *current;
+    baselineXRuns = xruns;
+    repaint();
+}
+
+void ProfilerOverlay::paint(juce::Graphics& g)
+{
+    g.setColour(juce::Colours::black.withAlpha(0.85f));
+    g.fillRoundedRectangle(getLocalBounds().toFloat(), 6.0f);
+
+    auto r = getLocalBounds().reduced(10);
+    const int rowH = 16;
+    const auto footer = r.removeFromBottom(rowH);
+
+    // one callback's worth of audio, averaged over the window
+    const auto callbacks = current->callbacks - baseline->callbacks;
+    const auto samples = current->samples - baseline->samples;
+    const double budgetMicros = callbacks > 0 && current->sampleRate > 0.0
+                              ? 1.0e6 * (double)samples / (double)callbacks / current->sampleRate
+                              : 0.0;
+
+    g.setFont(juce::FontOptions(13.0f, juce::Font::bold));
+    g.setColour(juce::Colours::white);
+    g.drawText("callbacks " + juce::String(callbacks)
+                   + "   late " + juce::String(current->deadlineMisses - baseline->deadlineMisses)
+                   + "   xruns " + juce::String(xruns - baselineXRuns)
+                   + "   budget " + juce::String(budgetMicros, 0) + " us",
+               r.removeFromTop(rowH + 4), juce::Justification::centredLeft);
+
+    // columns
+    const int nameW = r.getWidth() - 5 * 62;
+    auto drawRow = [&](juce::Rectangle<int> row, const juce::StringArray& cells)
+        {
+            g.drawText(cells[0], row.removeFromLeft(nameW), juce::Justification::centredLeft);
+            for (int i = 1; i < cells.size(); ++i)
+                g.drawText(cells[i], row.removeFromLeft(62), juce::Justification::centredRight);
+        };
+
+    g.setFont(juce::FontOptions(12.0f, juce::Font::bold));
+    g.setColour(juce::Colours::grey);
+    drawRow(r.removeFromTop(rowH), { "stage", "calls", "mean us", "p99 us", "max us", "budget" });
+
+    g.setFont(juce::FontOptions(12.0f));
+
+    for (int stage = 0; stage < AudioProfiler::numStages && r.getHeight() >= rowH; ++stage)
+    {
+        const auto stats = AudioProfiler::summarise(*current, *baseline, stage);
+
+        // stages that didn't run (empty deck slots, bypassed fx) are left out
+        if (stats.count == 0) continue;
+
+        const double percent = budgetMicros > 0.0 ? 100.0 * stats.meanMicros / budgetMicros : 0.0;
+
+        // red once a stage's worst block would eat the whole callback on its own
+        g.setColour(budgetMicros > 0.0 && stats.maxMicros > budgetMicros ? juce::Colours::orangered
+                                                                         : juce::Colours::white);
+
+        drawRow(r.removeFromTop(rowH), { AudioProfiler::getStageName(stage),
+                                         juce::String(stats.count),
+                                         juce::String(stats.meanMicros, 1),
+                                         juce::String(stats.p99Micros, 1),
+                                         juce::String(stats.maxMicros, 1),
+                                         juce::String(percent, 1) + "%" });
+    }
+
+    g.setColour(juce::Colours::grey);
+    g.setFont(juce::FontOptions(11.0f));
+    g.drawText("click to reset, ctrl/cmd+p to hide", footer, juce::Justification::centredRight);
+}
@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    ProfilerOverlay.h
+    Created: 18 Oct 2026 2:48:10am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioProfiler.h"
+
+// table of the profiler's stages on top of the app, refreshed a few times a second
+// only ever reads snapshots, the audio thread never waits for it
+// click to start a new measuring window
+class ProfilerOverlay : public juce::Component, private juce::Timer
+{
+public:
+    explicit ProfilerOverlay(const AudioProfiler& profiler);
+
+    // xrun count of the audio device, if it reports one
+    std::function<int()> getXRunCount;
+
+    void paint(juce::Graphics& g) override;
+    void mouseDown(const juce::MouseEvent&) override;
+    void visibilityChanged() override;
+
+private:
+    void timerCallback() override;
+
+    const AudioProfiler& profiler;
+
+    // measuring window: everything since the baseline
+    std::unique_ptr<AudioProfiler::Snapshot> current, baseline;
+    int baselineXRuns{ 0 };
+    int xruns{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProfilerOverlay)
+};
@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    ReadAheadSource.cpp
+    Created: 17 Oct 2026 10:12:40am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ReadAheadSource.h"
+
+// https://docs.juce.com/master/classBufferingAudioSource.html <-- same idea, but lock free
+// and with the fill level exposed so the deck can show it
+
+ReadAheadSource::ReadAheadSource(juce::AudioFormatReader* r,
+                                 juce::TimeSliceThread* ioThread,
+                                 double readAheadSeconds)
+    : reader(r),
+      thread(ioThread),
+      ringSize(juce::jmax(chunkSize * 2, (int)std::ceil(readAheadSeconds * r->sampleRate))),
+      totalLength(r->lengthInSamples)
+{
+    // mono files stay mono in the ring, anything wider keeps only its first two channels
+    ring.setSize(juce::jlimit(1, 2, (int)reader->numChannels), ringSize);
+    ring.clear();
+}
+
+ReadAheadSource::~ReadAheadSource()
+{
+    if (thread != nullptr)
+        thread->removeTimeSliceClient(this);
+}
+
+void ReadAheadSource::prime()
+{
+    while (readNextChunk()) {}
+}
+
+void ReadAheadSource::prepareToPlay(int, double)
+{
+    if (!isPrepared)
+    {
+        if (thread != nullptr)
+            thread->addTimeSliceClient(this);
+        isPrepared = true;
+    }
+}
+
+void ReadAheadSource::releaseResources()
+{
+    if (thread != nullptr)
+        thread->removeTimeSliceClient(this);
+    isPrepared = false;
+}
+
+// audio thread: copy what is decoded, pad the rest with silence
+void ReadAheadSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+{
+    auto& out = *info.buffer;
+    const int num = info.numSamples;
+
+    // on demand: decode up to the end of this block first
+    if (thread == nullptr)
+        while (bufferEnd.load(std::memory_order_relaxed) < readPosition.load(std::memory_order_relaxed) + num
+               && readNextChunk()) {}
+
+    juce::int64 pos = readPosition.load(std::memory_order_acquire);
+    const auto resets = windowResets.load(std::memory_order_acquire);
+    const auto start = bufferStart.load(std::memory_order_acquire);
+    const auto end = bufferEnd.load(std::memory_order_acquire);
+
+    out.clear(info.startSample, num);
+
+    // overlap between the request and the decoded window
+    const auto from = juce::jmax(pos, start);
+    const auto to = juce::jmin(pos + num, end);
+
+    if (to > from)
+    {
+        const int offset = (int)(from - pos);
+        const int count = (int)(to - from);
+        const int slot = (int)(from % ringSize);
+        const int first = juce::jmin(count, ringSize - slot);
+        const int ringCh = ring.getNumChannels();
+
+        for (int ch = 0; ch < out.getNumChannels(); ++ch)
+        {
+            const int src = juce::jmin(ch, ringCh - 1);
+            out.copyFrom(ch, info.startSample + offset, ring, src, slot, first);
+
+            // wrap around the end of the ring
+            if (count > first)
+                out.copyFrom(ch, info.startSample + offset + first, ring, src, 0, count - first);
+        }
+    }
+
+    // the i/o thread may have reused slots while we copied (a seek back that stays inside the window
+    // lets it fill ahead of the new playhead): whatever has dropped below the window since,
+    // or all of it if the window was emptied, may be torn
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto validFrom = windowResets.load(std::memory_order_relaxed) != resets
+                         ? to
+                         : juce::jlimit(from, juce::jmax(from, to), bufferStart.load(std::memory_order_relaxed));
+
+    if (validFrom > from)
+        out.clear(info.startSample + (int)(from - pos), (int)(validFrom - from));
+
+    // past the end of the track is just silence, anything else missing is an underrun
+    const auto needed = juce::jmin(pos + num, totalLength) - pos;
+    const auto got = juce::jmax((juce::int64)0, to - juce::jmax(from, validFrom));
+    if (needed > 0 && got < needed)
+        underruns.fetch_add(1, std::memory_order_relaxed);
+
+    // advance unless a seek landed while we were copying
+    readPosition.compare_exchange_strong(pos, pos + num, std::memory_order_release);
+}
+
+void ReadAheadSource::setNextReadPosition(juce::int64 newPosition)
+{
+    // the i/o thread notices the jump and refills from here
+    readPosition.store(newPosition, std::memory_order_release);
+}
+
+juce::int64 ReadAheadSource::getNextReadPosition() const
+{
+    return readPosition.load(std::memory_order_relaxed);
+}
+
+juce::int64 ReadAheadSource::getTotalLength() const
+{
+    return totalLength;
+}
+
+float ReadAheadSource::getBufferHealth() const
+{
+    const auto pos = readPosition.load(std::memory_order_relaxed);
+    const auto end = bufferEnd.load(std::memory_order_relaxed);
+
+    // near the end of the track the window only needs to cover what is left
+    const auto wanted = juce::jmin((juce::int64)ringSize, totalLength - pos);
+    if (wanted <= 0) return 1.0f;
+
+    return juce::jlimit(0.0f, 1.0f, (float)(end - pos) / (float)wanted);
+}
+
+double ReadAheadSource::getBufferedSeconds() const
+{
+    const auto ahead = bufferEnd.load(std::memory_order_relaxed) - readPosition.load(std::memory_order_relaxed);
+    return ahead > 0 ? (double)ahead / reader->sampleRate : 0.0;
+}
+
+int ReadAheadSource::useTimeSlice()
+{
+    // keep going while there is work, otherwise check back shortly for seeks
+    return readNextChunk() ? 1 : 5;
+}
+
+// i/o thread: keep the ring topped up ahead of the playhead
+bool ReadAheadSource::readNextChunk()
+{
+    const auto playPos = readPosition.load(std::memory_order_acquire);
+    auto start = bufferStart.load(std::memory_order_relaxed);
+    auto end = bufferEnd.load(std::memory_order_relaxed);
+
+    // seek outside the decoded window: empty it and start again at the playhead
+    // the order keeps [start, end) empty in between so the reader never sees stale data
+    if (playPos < start)
+    {
+        windowResets.fetch_add(1, std::memory_order_relaxed);
+        bufferEnd.store(playPos, std::memory_order_release);
+        bufferStart.store(playPos, std::memory_order_release);
+        start = end = playPos;
+    }
+    else if (playPos > end)
+    {
+        windowResets.fetch_add(1, std::memory_order_relaxed);
+        bufferStart.store(playPos, std::memory_order_release);
+        bufferEnd.store(playPos, std::memory_order_release);
+        start = end = playPos;
+    }
+
+    // never overwrite samples the audio thread has not played yet
+    const auto fillLimit = juce::jmin(playPos + ringSize, totalLength);
+    if (end >= fillLimit) return false;
+
+    const int num = (int)juce::jmin((juce::int64)chunkSize, fillLimit - end);
+
+    // slots about to be reused belonged to already played positions
+    const auto newStart = end + num - ringSize;
+    if (newStart > start)
+        bufferStart.store(newStart, std::memory_order_release);
+
+    // the window change is visible before any slot is overwritten, see the check after the copy
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const int slot = (int)(end % ringSize);
+    const int first = juce::jmin(num, ringSize - slot);
+
+    reader->read(&ring, slot, first, end, true, true);
+    if (num > first)
+        reader->read(&ring, 0, num - first, end + first, true, true);
+
+    // publish the new samples
+    bufferEnd.store(end + num, std::memory_order_release);
+    return true;
+}
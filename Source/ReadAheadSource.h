@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    ReadAheadSource.h
+    Created: 17 Oct 2026 10:12:40am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DeckStream.h"
+
+// streams a track from its reader into a ring buffer on a background thread
+// so the audio callback only ever copies already decoded samples
+// one producer (the shared i/o thread), one consumer (the audio thread)
+// without an i/o thread the consumer decodes what it needs itself (offline export)
+class ReadAheadSource : public DeckStream,
+                        private juce::TimeSliceClient
+{
+public:
+    // takes ownership of the reader, ioThread nullptr decodes on demand
+    ReadAheadSource(juce::AudioFormatReader* reader,
+                    juce::TimeSliceThread* ioThread,
+                    double readAheadSeconds);
+    ~ReadAheadSource() override;
+
+    // decode the whole read-ahead window up front
+    void prime() override;
+
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    // positions are in file samples
+    void setNextReadPosition(juce::int64 newPosition) override;
+    juce::int64 getNextReadPosition() const override;
+    juce::int64 getTotalLength() const override;
+
+    // 0..1 how much of the read-ahead window is decoded (1 = full or rest of track buffered)
+    float getBufferHealth() const override;
+
+    // decoded audio ahead of the playhead
+    double getBufferedSeconds() const;
+
+    // blocks that had to be padded with silence because the reader fell behind
+    int getUnderrunCount() const override { return underruns.load(std::memory_order_relaxed); }
+
+    juce::AudioFormatReader* getAudioFormatReader() const { return reader.get(); }
+
+private:
+    int useTimeSlice() override;
+
+    // decode the next chunk into the ring, false if nothing to do
+    bool readNextChunk();
+
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    juce::TimeSliceThread* thread;
+
+    // ring of decoded samples, slot = position % ringSize
+    juce::AudioBuffer<float> ring;
+    const int ringSize;
+    const juce::int64 totalLength;
+
+    // valid range [bufferStart, bufferEnd) in file samples, written by the i/o thread
+    std::atomic<juce::int64> bufferStart{ 0 };
+    std::atomic<juce::int64> bufferEnd{ 0 };
+
+    // bumped whenever a seek empties the window, so a copy that spanned it can tell
+    std::atomic<juce::uint32> windowResets{ 0 };
+
+    // playhead, advanced by the audio thread, moved by seeks
+    std::atomic<juce::int64> readPosition{ 0 };
+
+    std::atomic<int> underruns{ 0 };
+    bool isPrepared{ false };
+
+    // size of each decode step
+    static constexpr int chunkSize = 8192;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ReadAheadSource)
+};
@@ -12,21 +12,64 @@
 #include "SampleAudioSource.h"
 // one-shot sample player that mixes into output buffer
 
-// prepare: store sample rate if needed later
+SampleAudioSource::SampleAudioSource(juce::TimeSliceThread* thread)
+    : ioThread(thread)
+{
+    // file rates until prepareToPlay says otherwise
+    sampleFolder = findSamplesFolder();
+    publish(loadBank(sampleFolder, 0.0, 0));
+
+    // nothing to convert yet
+    conversionDone.signal();
+
+    if (ioThread != nullptr)
+        ioThread->addTimeSliceClient(this);
+}
+
+SampleAudioSource::~SampleAudioSource()
+{
+    if (ioThread != nullptr)
+        ioThread->removeTimeSliceClient(this);
+
+    // a running load bails out at the next file
+    ++loadGeneration;
+    converterPool.removeAllJobs(true, -1);
+}
+
+// prepare: size the declick fade and the stream rings, load the bank at this rate
 void SampleAudioSource::prepareToPlay(int, double sampleRate)
 {
+    fadeSamples = juce::jmax(1, (int)(0.005 * sampleRate));
+
+    stopVoices();
+
+    {
+        // the streamer touches the rings under the same lock
+        const juce::ScopedLock sl(bankLock);
+        for (auto& st : streams)
+            st.ring.setSize(2, juce::jmax(1024, (int)(ringSeconds * sampleRate)));
+    }
+
+    // already there or on its way
+    if (sampleRate == fs) return;
+
     fs = sampleRate;
+    scheduleLoad(sampleFolder, sampleRate);
 }
 
-// clear voices and loaded samples
+// stop every voice, the bank stays loaded
 void SampleAudioSource::releaseResources()
 {
-    const juce::ScopedLock sl(lock);
-    voices.clear();
-    samples.clear();
+    stopVoices();
+}
+
+void SampleAudioSource::setSampleFolder(const juce::File& folder)
+{
+    sampleFolder = folder;
+    scheduleLoad(folder, fs);
 }
 
-// mix each active voice into output and remove finished voices
+// mix each active voice into output and free finished voices
 void SampleAudioSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
 {
     auto* out = info.buffer;
@@ -35,94 +78,404 @@ void SampleAudioSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& in
     // clear
     out->clear(info.startSample, info.numSamples);
 
-    const juce::ScopedLock sl(lock);
-    if (voices.empty()) return;
-
-    // get channels
-    const int outCh = out->getNumChannels();
+    // pads hit since the last block
+    triggerFifo.read(triggerFifo.getNumReady()).forEach([this](int index) { startVoice(triggerQueue[(size_t)index]); });
 
     // mix all active voices
-    for (auto it = voices.begin(); it != voices.end(); )
+    for (int i = 0; i < numVoiceSlots; ++i)
+        if (voices[(size_t)i].sample != nullptr)
+            mixVoice(i, *out, info.startSample, info.numSamples);
+}
+
+void SampleAudioSource::mixVoice(int index, juce::AudioBuffer<float>& out, int startSample, int numSamples)
+{
+    auto& v = voices[(size_t)index];
+    auto& st = streams[(size_t)index];
+    const Sample& s = *v.sample;
+
+    const int headLength = s.head.getNumSamples();
+    const int ringSize = st.ring.getNumSamples();
+
+    int toPlay = std::min(s.length - v.pos, numSamples);
+    if (v.fadeLeft >= 0) toPlay = std::min(toPlay, v.fadeLeft);
+
+    // gain at an offset into this block, ramps to silence while fading
+    auto gainAt = [&](int offset)
+        {
+            return v.fadeLeft < 0 ? v.gain : v.gain * (float)(v.fadeLeft - offset) / (float)fadeSamples;
+        };
+
+    int done = 0;
+    while (done < toPlay)
     {
-        Voice& v = *it;
-        if (v.sample == nullptr || v.sample->buffer.getNumSamples() <= 0)
+        const juce::AudioBuffer<float>* src = &s.head;
+        int srcPos = v.pos;
+        int n = toPlay - done;
+
+        if (v.pos < headLength)
         {
-            it = voices.erase(it); continue;
+            n = std::min(n, headLength - v.pos);
         }
+        else
+        {
+            // no streaming thread: read what this block needs right here
+            if (ioThread == nullptr)
+                while ((int)(st.filled.load(std::memory_order_acquire) & 0xffffffffu) < v.pos + n && fillStream(index)) {}
 
-        const auto& sbuf = v.sample->buffer;
-        const int srcCh = sbuf.getNumChannels();
-        const int remaining = sbuf.getNumSamples() - v.pos;
+            const int available = (int)(st.filled.load(std::memory_order_acquire) & 0xffffffffu) - v.pos;
 
-        if (remaining <= 0) { it = voices.erase(it); continue; }
+            // disk fell behind: skip the gap so the voice stays in time
+            if (available <= 0 || ringSize == 0)
+            {
+                underruns.store(underruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                v.pos += n;
 
-        const int toCopy = std::min(remaining, info.numSamples);
+                // and move the stream up with it, so it reads on from here instead of the skipped audio
+                // a fill in flight fails its exchange and starts again from the new position
+                auto filled = st.filled.load(std::memory_order_acquire);
+                while ((int)(filled & 0xffffffffu) < v.pos
+                       && !st.filled.compare_exchange_weak(filled, (filled & ~(juce::uint64)0xffffffffu) | (juce::uint64)v.pos,
+                                                           std::memory_order_release, std::memory_order_acquire)) {}
+                break;
+            }
 
-        // add data to output channel
-        for (int ch = 0; ch < outCh; ++ch)
-        {
-            const float* src = sbuf.getReadPointer(std::min(ch, srcCh - 1), v.pos);
-            float* dst = out->getWritePointer(ch, info.startSample);
-            juce::FloatVectorOperations::addWithMultiply(dst, src, v.gain, toCopy);
+            src = &st.ring;
+            srcPos = v.pos % ringSize;
+            n = std::min({ n, available, ringSize - srcPos });
         }
 
-        v.pos += toCopy;
+        // add data to output channel, sources are stereo
+        for (int ch = 0; ch < out.getNumChannels(); ++ch)
+        {
+            const float* from = src->getReadPointer(std::min(ch, 1), srcPos);
+
+            if (v.fadeLeft < 0)
+                juce::FloatVectorOperations::addWithMultiply(out.getWritePointer(ch, startSample + done), from, v.gain, n);
+            else
+                // stolen: ramp down to silence instead of cutting mid waveform
+                out.addFromWithRamp(ch, startSample + done, from, n, gainAt(done), gainAt(done + n));
+        }
 
-        // remove when sample finishes
-        if (v.pos >= sbuf.getNumSamples()) it = voices.erase(it);
-        else ++it;
+        v.pos += n;
+        done += n;
     }
+
+    if (v.fadeLeft >= 0) v.fadeLeft -= toPlay;
+
+    // room for the streamer
+    st.consumed.store(v.pos, std::memory_order_release);
+
+    // free the slot when the sample or its fade finishes
+    if (v.pos >= s.length || v.fadeLeft == 0)
+        releaseVoice(index);
+}
+
+void SampleAudioSource::releaseVoice(int index)
+{
+    auto& v = voices[(size_t)index];
+    if (v.sample == nullptr) return;
+
+    // the stream lets go first, the bank can't be retired while the streamer still reads it
+    streams[(size_t)index].sample.store(nullptr, std::memory_order_release);
+    v.sample->bank->users.fetch_sub(1, std::memory_order_release);
+    v = Voice{};
 }
 
 // trigger a one - shot sample by id
 void SampleAudioSource::trigger(const juce::String& id, float gain)
 {
-    if (!ensureSampleLoaded(id)) return;
+    // the bank can't be retired between finding the sample and queuing it
+    const juce::ScopedLock sl(triggerLock);
+
+    const auto* bank = liveBank.load(std::memory_order_acquire);
+    if (bank == nullptr) return;
+
+    for (const auto& s : bank->samples)
+    {
+        if (s->id != id) continue;
+
+        // a full queue drops the hit rather than waiting for the audio thread
+        const auto scope = triggerFifo.write(1);
+        if (scope.blockSize1 > 0)
+        {
+            // handed on to the voice that plays it
+            s->bank->users.fetch_add(1, std::memory_order_relaxed);
+            triggerQueue[(size_t)scope.startIndex1] = Trigger{ s.get(), gain };
+        }
+
+        return;
+    }
+}
+
+// audio thread: take a free voice, making room by fading out the oldest one
+void SampleAudioSource::startVoice(const Trigger& t)
+{
+    // cap simultaneous voices, fading ones don't count
+    int playing = 0;
+    Voice* oldest = nullptr;
 
-    const juce::ScopedLock sl(lock);
-    auto it = samples.find(id.toStdString());
-    if (it == samples.end()) return;
+    for (auto& v : voices)
+    {
+        if (v.sample == nullptr || v.fadeLeft >= 0) continue;
+
+        ++playing;
+        if (oldest == nullptr || v.age < oldest->age) oldest = &v;
+    }
+
+    if (playing >= maxVoices && oldest != nullptr)
+        oldest->fadeLeft = fadeSamples;
+
+    Voice* slot = nullptr;
+    for (auto& v : voices)
+        if (v.sample == nullptr) { slot = &v; break; }
+
+    // every spare slot is still fading, cut the one closest to silence
+    if (slot == nullptr)
+    {
+        for (auto& v : voices)
+            if (v.fadeLeft >= 0 && (slot == nullptr || v.fadeLeft < slot->fadeLeft)) slot = &v;
+
+        releaseVoice((int)(slot - voices.data()));
+    }
 
-    // cap simultaneous voices to avoid memory problems
-    if (voices.size() > 16) voices.erase(voices.begin());
+    // takes over the trigger's hold on the bank
+    *slot = Voice{ t.sample, 0, t.gain, nextAge++, -1 };
 
-    voices.push_back(Voice{ &it->second, 0, gain });
+    // restart the stream after the resident head
+    auto& st = streams[(size_t)(slot - voices.data())];
+    ++st.restarts;
+    st.consumed.store(0, std::memory_order_relaxed);
+    st.sample.store(t.sample, std::memory_order_release);
+    st.filled.store(((juce::uint64)st.restarts << 32) | (juce::uint64)t.sample->head.getNumSamples(), std::memory_order_release);
 }
 
-// ensure a sample with this id is present in cache & try assets / samples
-bool SampleAudioSource::ensureSampleLoaded(const juce::String& id)
+bool SampleAudioSource::fillStream(int index)
 {
-    const std::string key = id.toStdString();
-    if (samples.find(key) != samples.end()) return true;
+    auto& st = streams[(size_t)index];
+    const int ringSize = st.ring.getNumSamples();
 
-    auto root = findSamplesFolder();     // Assets/Samples
-    if (!root.isDirectory()) return false;
+    auto filled = st.filled.load(std::memory_order_acquire);
+    const auto* s = st.sample.load(std::memory_order_acquire);
+    if (s == nullptr || s->reader == nullptr || ringSize == 0) return false;
 
-    // allow few file extensions (most will be wav or mp3)
-    static const char* exts[] = { ".wav", ".mp3", ".flac"};
-    juce::File f;
+    // never overwrite what the voice hasn't played yet
+    const int pos = (int)(filled & 0xffffffffu);
+    const int consumed = std::max(st.consumed.load(std::memory_order_acquire), s->head.getNumSamples());
+    const int n = std::min({ ringSize - (pos - consumed), s->length - pos, ringSize - pos % ringSize, 8192 });
+
+    // small reads cost as much as big ones, wait for room unless it's the end
+    if (n <= 0 || (n < 1024 && pos + n < s->length)) return false;
+
+    s->reader->read(&st.ring, pos % ringSize, n, pos, true, true);
+
+    // fails if the voice restarted meanwhile, the next pass starts over for the new sample
+    return st.filled.compare_exchange_strong(filled, (filled & ~(juce::uint64)0xffffffffu) | (juce::uint64)(pos + n),
+                                             std::memory_order_release, std::memory_order_relaxed);
+}
+
+int SampleAudioSource::useTimeSlice()
+{
+    int reads = 0;
+
+    {
+        const juce::ScopedLock sl(bankLock);
+
+        // a few reads per slice, round robin so every voice gets its turn
+        for (int i = 0; i < numVoiceSlots && reads < readsPerSlice; ++i)
+        {
+            if (fillStream(nextStream)) ++reads;
+            nextStream = (nextStream + 1) % numVoiceSlots;
+        }
+    }
+
+    retireBanks();
+
+    // straight back while there may be more to read, otherwise poll well inside the resident head
+    return reads == readsPerSlice ? 0 : 10;
+}
+
+void SampleAudioSource::scheduleLoad(const juce::File& folder, double rate)
+{
+    // stop loading for the old folder / rate
+    const int generation = ++loadGeneration;
+    converterPool.removeAllJobs(true, -1);
+
+    conversionDone.reset();
+    converterPool.addJob([this, folder, rate, generation]
+        {
+            auto bank = loadBank(folder, rate, generation);
+            if (bank != nullptr && generation == loadGeneration.load())
+                publish(std::move(bank));
+
+            conversionDone.signal();
+        });
+}
+
+void SampleAudioSource::publish(std::unique_ptr<Bank> bank)
+{
+    {
+        const juce::ScopedLock sl(bankLock);
+        const juce::ScopedLock tl(triggerLock);
+        liveBank.store(bank.get(), std::memory_order_release);
+        banks.push_back(std::move(bank));
+    }
+
+    // the previous one may already be idle
+    retireBanks();
+}
+
+void SampleAudioSource::stopVoices()
+{
+    // nothing renders now, pending triggers hold their bank too
+    triggerFifo.read(triggerFifo.getNumReady()).forEach([this](int index)
+        {
+            triggerQueue[(size_t)index].sample->bank->users.fetch_sub(1, std::memory_order_release);
+        });
+
+    for (int i = 0; i < numVoiceSlots; ++i)
+        releaseVoice(i);
+
+    retireBanks();
+}
+
+void SampleAudioSource::retireBanks()
+{
+    const juce::ScopedLock sl(bankLock);
+    const juce::ScopedLock tl(triggerLock);
+
+    const auto* live = liveBank.load(std::memory_order_acquire);
+    banks.erase(std::remove_if(banks.begin(), banks.end(), [live](const auto& b)
+        {
+            return b.get() != live && b->users.load(std::memory_order_acquire) == 0;
+        }), banks.end());
+}
+
+// load every sample in the folder, the start of each into memory
+std::unique_ptr<SampleAudioSource::Bank> SampleAudioSource::loadBank(const juce::File& folder, double rate, int generation)
+{
+    auto bank = std::make_unique<Bank>();
+    bank->sampleRate = rate;
+
+    if (!folder.isDirectory()) return bank;
+
+    // allow few file extensions (most will be wav or mp3), earlier ones win for the same name
+    static const char* exts[] = { ".wav", ".aiff", ".aif", ".flac", ".mp3" };
 
-    // add files
     for (auto* e : exts)
     {
-        auto cand = root.getChildFile(id + e);
-        if (cand.existsAsFile()) { f = cand; break; }
+        auto files = folder.findChildFiles(juce::File::findFiles, false, juce::String("*") + e);
+        files.sort();
+
+        for (const auto& f : files)
+        {
+            if (loadGeneration.load() != generation) return nullptr;
+
+            const auto id = f.getFileNameWithoutExtension();
+
+            const bool known = std::any_of(bank->samples.begin(), bank->samples.end(),
+                                           [&](const auto& s) { return s->id == id; });
+            if (known) continue;
+
+            auto reader = openReader(f);
+            if (!reader || reader->lengthInSamples <= 0) continue;
+
+            // stream the device rate copy from the cache, converting it first if this is new
+            if (rate > 0.0 && reader->sampleRate != rate)
+            {
+                const auto cacheFile = getCacheFile(f, rate);
+                auto cached = openReader(cacheFile);
+
+                if (cached == nullptr || cached->sampleRate != rate || cached->lengthInSamples <= 0)
+                {
+                    if (!convertToFile(*reader, cacheFile, rate, generation))
+                        return nullptr;
+
+                    cached = openReader(cacheFile);
+                }
+
+                // if the cache can't be written the pad just plays at the file rate
+                if (cached != nullptr && cached->lengthInSamples > 0)
+                    reader = std::move(cached);
+            }
+
+            auto sample = std::make_unique<Sample>();
+            sample->bank = bank.get();
+            sample->id = id;
+            sample->length = (int)juce::jmin((juce::int64)std::numeric_limits<int>::max(), reader->lengthInSamples);
+
+            const int headLength = juce::jmin(sample->length, (int)(residentSeconds * reader->sampleRate));
+            sample->head.setSize(2, headLength);
+            reader->read(&sample->head, 0, headLength, 0, true, true);
+
+            // short one-shots are all head, nothing left to stream
+            if (headLength < sample->length)
+                sample->reader = std::move(reader);
+
+            bank->samples.push_back(std::move(sample));
+        }
     }
-    if (!f.existsAsFile()) return false;
 
-    auto reader = openReader(f);
-    if (!reader) return false;
+    return bank;
+}
+
+bool SampleAudioSource::convertToFile(juce::AudioFormatReader& reader, const juce::File& cacheFile, double rate, int generation)
+{
+    // a failed write only costs another conversion next launch
+    if (!cacheFile.getParentDirectory().createDirectory()) return true;
 
-    SampleData data;
+    const int channels = juce::jlimit(1, 2, (int)reader.numChannels);
+    const auto length = (juce::int64)std::ceil((double)reader.lengthInSamples * rate / reader.sampleRate);
 
-    data.buffer.setSize((int)reader->numChannels, (int)reader->lengthInSamples);
-    reader->read(&data.buffer, 0, (int)reader->lengthInSamples, 0, true, true);
+    // written next to it and swapped in, a crash never leaves half a file
+    juce::TemporaryFile temp(cacheFile);
+    std::unique_ptr<juce::OutputStream> stream(temp.getFile().createOutputStream());
+    if (stream == nullptr) return true;
 
-    samples.emplace(key, std::move(data));
+    // 32 bit float, bit exact with what was converted
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), rate, (unsigned int)channels, 32, {}, 0));
+    if (writer == nullptr) return true;
+    stream.release();
+
+    // same sinc resampler as the decks at its best setting, streamed so long loops never sit in ram
+    juce::AudioFormatReaderSource input(&reader, false);
+    SincResamplingSource resampler(&input, channels);
+    resampler.setQuality(SincResamplingSource::Quality::high);
+
+    const int block = 4096;
+    resampler.prepareToPlay(block, rate);
+    resampler.setResamplingRatio(reader.sampleRate / rate);
+
+    juce::AudioBuffer<float> buffer(channels, block);
+    bool written = true;
+
+    for (juce::int64 done = 0; done < length && written; done += block)
+    {
+        if (loadGeneration.load() != generation) return false;
+
+        const int n = (int)juce::jmin((juce::int64)block, length - done);
+        resampler.getNextAudioBlock(juce::AudioSourceChannelInfo(&buffer, 0, n));
+        written = writer->writeFromAudioSampleBuffer(buffer, 0, n);
+    }
+
+    resampler.releaseResources();
+    writer.reset();
+
+    if (written)
+        temp.overwriteTargetFileWithTemporary();
 
     return true;
 }
 
+// one file per sample content and rate, renamed or moved samples still hit
+juce::File SampleAudioSource::getCacheFile(const juce::File& sampleFile, double rate)
+{
+    auto dir = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                   .getChildFile(juce::String(ProjectInfo::projectName)).getChildFile("PadCache");
+
+    return dir.getChildFile(juce::MD5(sampleFile).toHexString() + "_" + juce::String(juce::roundToInt(rate)) + ".wav");
+}
+
 // try to find assets/samples folder near executable or current working directory
 juce::File SampleAudioSource::findSamplesFolder()
 {
@@ -141,7 +494,15 @@ juce::File SampleAudioSource::findSamplesFolder()
 
 std::unique_ptr<juce::AudioFormatReader> SampleAudioSource::openReader(const juce::File& f)
 {
-    static juce::AudioFormatManager fm; static bool inited = false;
-    if (!inited) { fm.registerBasicFormats(); inited = true; }
-    return std::unique_ptr<juce::AudioFormatReader>(fm.createReaderFor(f));
+    if (!f.existsAsFile()) return nullptr;
+
+    // banks can load on more than one thread (the live one, an export), set up once
+    static const auto fm = []
+        {
+            auto m = std::make_unique<juce::AudioFormatManager>();
+            m->registerBasicFormats();
+            return m;
+        }();
+
+    return std::unique_ptr<juce::AudioFormatReader>(fm->createReaderFor(f));
 }
@@ -10,44 +10,180 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include "SincResamplingSource.h"
 // Audio source class for sample playback
-class SampleAudioSource : public juce::AudioSource
+// every sample keeps its first few hundred ms in memory, the rest streams from disk
+// into a ring per voice, so kits and long loops of any size load without filling ram
+// triggers reach the audio thread through a lock-free fifo and voices come from a fixed pool,
+// so playing pads never locks, allocates or touches the disk
+class SampleAudioSource : public juce::AudioSource,
+                          private juce::TimeSliceClient
 {
 public:
-    SampleAudioSource() = default;
-    ~SampleAudioSource() override = default;
+    // loads Assets/Samples
+    // streams on ioThread, nullptr reads on demand while rendering (offline, never falls behind)
+    explicit SampleAudioSource(juce::TimeSliceThread* ioThread = nullptr);
+    ~SampleAudioSource() override;
 
     void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
     void releaseResources() override;
     void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
 
-    // trigger sample by id
+    // trigger sample by id, plays from the start of the next block
+    // one triggering thread at a time (the message thread live, the render thread offline)
     void trigger(const juce::String& id, float gain = 1.0f);
 
+    // every wav / aiff / flac / mp3 in the folder becomes a pad, named after the file
+    // (kick, snare, drum, scratch, glitch for the deck pads)
+    // loads in the background, the old bank keeps playing until it is ready
+    void setSampleFolder(const juce::File& folder);
+    juce::File getSampleFolder() const { return sampleFolder; }
+
+    // voices playing at once, the oldest is faded out to make room
+    static constexpr int maxVoices = 32;
+
+    // resident start of every sample, covers the i/o thread's first read
+    static constexpr double residentSeconds = 0.3;
+
+    // streamed audio buffered ahead of each voice
+    static constexpr double ringSeconds = 0.5;
+
+    // disk reads per time slice, so one busy kit can't hog the streaming thread
+    static constexpr int readsPerSlice = 4;
+
+    // the bank is loaded again at the device rate in the background after prepareToPlay
+    // (and after a folder change), pads play the previous bank until then
+    // blocks until that has finished (offline renders), false on timeout
+    bool waitForConversion(int timeoutMs = -1) { return conversionDone.wait(timeoutMs); }
+
+    // times the disk fell behind a voice
+    int getStreamUnderruns() const { return underruns.load(std::memory_order_relaxed); }
+
 private:
-    struct SampleData
+    struct Bank;
+
+    struct Sample
     {
-        juce::AudioBuffer<float> buffer; // separate channels
+        // the bank it belongs to
+        Bank* bank{ nullptr };
+
+        juce::String id;
+        int length{ 0 };
+
+        // first residentSeconds, always stereo
+        juce::AudioBuffer<float> head;
+
+        // the rest, only read by whoever streams (i/o thread, or the renderer without one)
+        std::unique_ptr<juce::AudioFormatReader> reader;
+    };
+
+    // one folder at one rate, read only once published
+    struct Bank
+    {
+        double sampleRate{ 0.0 };
+        std::vector<std::unique_ptr<Sample>> samples;
+
+        // queued triggers and voices playing one of its samples
+        // a bank that is no longer live is freed once this drops to 0
+        std::atomic<int> users{ 0 };
     };
 
     struct Voice
     {
-        const SampleData* sample = nullptr;
+        const Sample* sample = nullptr;
         // current frame
-        int pos = 0;          
+        int pos = 0;
+        float gain = 1.0f;
+        // trigger order, lowest is stolen first
+        juce::uint32 age = 0;
+        // samples left of a declick fade, -1 while playing normally
+        int fadeLeft = -1;
+    };
+
+    // disk side of a voice, same index
+    // the audio thread restarts it, the streamer fills it; filled packs the audio thread's
+    // restart count (high 32 bits) with the frame streamed up to, so a fill meant for the
+    // voice's previous sample can never be published over a restart
+    struct Stream
+    {
+        std::atomic<const Sample*> sample{ nullptr };
+        std::atomic<juce::uint64> filled{ 0 };
+        std::atomic<int> consumed{ 0 };
+        juce::uint32 restarts{ 0 };   // audio thread
+        juce::AudioBuffer<float> ring;
+    };
+
+    struct Trigger
+    {
+        const Sample* sample = nullptr;
         float gain = 1.0f;
     };
 
-    double fs{ 44100.0 };
-    juce::CriticalSection lock;
+    static constexpr int numVoiceSlots = maxVoices + maxVoices / 2;
+
+    double fs{ 0.0 };
+
+    // ~5ms, long enough to hide the cut of a stolen voice
+    int fadeSamples{ 220 };
+
+    juce::TimeSliceThread* const ioThread;
+
+    // published banks, the live one and any still referenced by voices
+    // bankLock covers the streamer's reads, triggerLock finding and queuing a sample,
+    // a bank is only freed holding both
+    juce::CriticalSection bankLock;
+    juce::CriticalSection triggerLock;
+    std::vector<std::unique_ptr<Bank>> banks;
+    std::atomic<const Bank*> liveBank{ nullptr };
+    juce::File sampleFolder;
+
+    // triggers from the ui, drained at the start of every block
+    juce::AbstractFifo triggerFifo{ 64 };
+    std::array<Trigger, 64> triggerQueue;
+
+    // audio thread only, stolen voices keep a slot while they fade
+    std::array<Voice, numVoiceSlots> voices;
+    std::array<Stream, numVoiceSlots> streams;
+    juce::uint32 nextAge{ 0 };
+    std::atomic<int> underruns{ 0 };
+
+    // streamer: next stream to look at, round robin across slices
+    int nextStream{ 0 };
 
-    // id --> sample
-    std::unordered_map<std::string, SampleData> samples;
-    // active voices
-    std::vector<Voice> voices;
+    // newest folder / rate wins, older loads give up
+    std::atomic<int> loadGeneration{ 0 };
+    juce::WaitableEvent conversionDone{ true };
 
-    bool ensureSampleLoaded(const juce::String& id);
+    void startVoice(const Trigger& t);
+    void mixVoice(int index, juce::AudioBuffer<float>& out, int startSample, int numSamples);
+
+    // audio thread: frees the slot and lets go of its bank
+    void releaseVoice(int index);
+
+    // streamer: tops up one voice's ring, true if it read anything
+    bool fillStream(int index);
+    int useTimeSlice() override;
+
+    // replaces the bank in the background, rate 0 keeps every file's own rate
+    void scheduleLoad(const juce::File& folder, double rate);
+    void publish(std::unique_ptr<Bank> bank);
+
+    // audio stopped: drops every voice and pending trigger, then retires unused banks
+    void stopVoices();
+
+    // frees banks that are no longer live and that nothing plays or streams from
+    void retireBanks();
+
+    // converter thread (or the constructor): opens, converts and caches every sample in the folder
+    std::unique_ptr<Bank> loadBank(const juce::File& folder, double rate, int generation);
+
+    // streams a file through the sinc resampler into a device rate cache file
+    bool convertToFile(juce::AudioFormatReader& reader, const juce::File& cacheFile, double rate, int generation);
+    static juce::File getCacheFile(const juce::File& sampleFile, double rate);
     static juce::File findSamplesFolder();
     static std::unique_ptr<juce::AudioFormatReader> openReader(const juce::File& f);
-};
 
+    // loads run off the audio and message threads
+    // declared last so a running load stops before the banks go away
+    juce::ThreadPool converterPool{ 1 };
+};
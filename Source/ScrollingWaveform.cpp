@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    ScrollingWaveform.cpp
+    Created: 18 Oct 2026 4:58:21am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ScrollingWaveform.h"
+#include "WaveformDisplay.h"
+#include "Theme.h"
+
+ScrollingWaveform::ScrollingWaveform()
+{
+    // tiles and background cover every pixel
+    setOpaque(true);
+}
+
+void ScrollingWaveform::setPyramid(std::shared_ptr<const WaveformPyramid> newPyramid)
+{
+    pyramid = std::move(newPyramid);
+    clearTiles();
+}
+
+void ScrollingWaveform::setPlayheadSeconds(double seconds)
+{
+    playheadSeconds = seconds;
+
+    if (pyramid == nullptr) return;
+
+    // same view to the pixel, nothing to draw (paused, or zoomed far out)
+    const double left = seconds * pyramid->getSampleRate() / getSamplesPerPixel() - getWidth() * 0.5;
+    if (std::abs(left - paintedLeft) < 0.25) return;
+
+    repaint();
+}
+
+void ScrollingWaveform::setVisibleSeconds(double seconds)
+{
+    visibleSeconds = juce::jlimit(0.5, 60.0, seconds);
+    clearTiles();
+}
+
+void ScrollingWaveform::mouseWheelMove(const juce::MouseEvent&, const juce::MouseWheelDetails& wheel)
+{
+    // up zooms in
+    setVisibleSeconds(visibleSeconds * (wheel.deltaY > 0.0f ? 0.8 : 1.25));
+}
+
+void ScrollingWaveform::resized()
+{
+    clearTiles();
+}
+
+void ScrollingWaveform::lookAndFeelChanged()
+{
+    clearTiles();
+}
+
+void ScrollingWaveform::clearTiles()
+{
+    tiles.clear();
+    paintedLeft = -1.0;
+    repaint();
+}
+
+double ScrollingWaveform::getSamplesPerPixel() const
+{
+    const double rate = pyramid != nullptr ? pyramid->getSampleRate() : 44100.0;
+    return juce::jmax(1.0, visibleSeconds * rate / juce::jmax(1, getWidth()));
+}
+
+const juce::Image& ScrollingWaveform::getTile(juce::int64 index, float scale)
+{
+    auto& tile = tiles[index];
+    if (tile.isValid()) return tile;
+
+    const int w = juce::roundToInt(tileWidth * scale);
+    const int h = juce::jmax(1, juce::roundToInt(getHeight() * scale));
+    tile = juce::Image(juce::Image::ARGB, w, h, true);
+
+    juce::Graphics g(tile);
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+
+    // one column per physical pixel
+    const double samplesPerColumn = getSamplesPerPixel() / scale;
+    const double firstColumn = (double)index * w;
+    const float midY = h * 0.5f;
+
+    for (int px = 0; px < w; ++px)
+    {
+        const auto start = (juce::int64)((firstColumn + px) * samplesPerColumn);
+        const auto end = (juce::int64)((firstColumn + px + 1) * samplesPerColumn);
+
+        // before the start or past the end of the track
+        if (end <= 0 || start >= pyramid->getLengthInSamples()) continue;
+
+        const auto range = pyramid->getRange(start, end);
+        const auto colour = WaveformDisplay::getBandColour(range);
+
+        g.setColour(colour.withMultipliedAlpha(0.6f));
+        g.fillRect((float)px, midY - range.max * midY, 1.0f, juce::jmax(1.0f, (range.max - range.min) * midY));
+
+        g.setColour(colour);
+        g.fillRect((float)px, midY - range.rms * midY, 1.0f, range.rms * 2.0f * midY);
+    }
+
+    return tile;
+}
+
+void ScrollingWaveform::paint(juce::Graphics& g)
+{
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+
+    if (pyramid != nullptr)
+    {
+        const float scale = (float)g.getInternalContext().getPhysicalPixelScaleFactor();
+        if (scale != tileScale)
+        {
+            tiles.clear();
+            tileScale = scale;
+        }
+
+        // playhead in the middle, whole physical pixels so tiles blit without resampling
+        const double left = playheadSeconds * pyramid->getSampleRate() / getSamplesPerPixel() - getWidth() * 0.5;
+        const double snappedLeft = std::floor(left * scale) / scale;
+        paintedLeft = left;
+
+        const auto firstTile = (juce::int64)std::floor(snappedLeft / tileWidth);
+        const auto lastTile = (juce::int64)std::floor((snappedLeft + getWidth()) / tileWidth);
+
+        for (auto t = firstTile; t <= lastTile; ++t)
+        {
+            const float x = (float)((double)t * tileWidth - snappedLeft);
+            g.drawImage(getTile(t, scale), { x, 0.0f, (float)tileWidth, (float)getHeight() });
+        }
+
+        // tiles that scrolled out of view
+        for (auto it = tiles.begin(); it != tiles.end();)
+            it = (it->first < firstTile - 1 || it->first > lastTile + 1) ? tiles.erase(it) : std::next(it);
+    }
+
+    g.setColour(Theme::panelBg);
+    g.drawRect(getLocalBounds(), 1);
+
+    g.setColour(Theme::accent);
+    g.fillRect(juce::Rectangle<float>(getWidth() * 0.5f - 1.0f, 0.0f, 2.0f, (float)getHeight()));
+}
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    ScrollingWaveform.h
+    Created: 18 Oct 2026 4:58:21am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "WaveformPyramid.h"
+
+// zoomed waveform that scrolls under a fixed playhead in the middle
+// the track is drawn once into fixed-width tiles, so a frame is a few image blits,
+// plus one new tile when the playhead has moved far enough to expose it
+class ScrollingWaveform : public juce::Component
+{
+public:
+    ScrollingWaveform();
+
+    // nullptr shows nothing
+    void setPyramid(std::shared_ptr<const WaveformPyramid> newPyramid);
+
+    // call every frame, repaints only if the view actually moved
+    void setPlayheadSeconds(double seconds);
+
+    // how much of the track is across the whole width, the mouse wheel zooms too
+    void setVisibleSeconds(double seconds);
+    double getVisibleSeconds() const { return visibleSeconds; }
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    void lookAndFeelChanged() override;
+    void mouseWheelMove(const juce::MouseEvent&, const juce::MouseWheelDetails& wheel) override;
+
+    // logical pixels per tile
+    static constexpr int tileWidth = 256;
+
+private:
+    // track samples per logical pixel at the current zoom
+    double getSamplesPerPixel() const;
+
+    // tile k covers track pixels [k * tileWidth, (k + 1) * tileWidth)
+    const juce::Image& getTile(juce::int64 index, float scale);
+    void clearTiles();
+
+    std::shared_ptr<const WaveformPyramid> pyramid;
+    double playheadSeconds{ 0.0 };
+    double visibleSeconds{ 8.0 };
+
+    // left edge of the view in track pixels, as last painted
+    double paintedLeft{ -1.0 };
+
+    std::map<juce::int64, juce::Image> tiles;
+    float tileScale{ 0.0f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScrollingWaveform)
+};
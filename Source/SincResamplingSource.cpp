@@ -0,0 +1,304 @@
+/*
+  ==============================================================================
+
+    SincResamplingSource.cpp
+    Created: 17 Oct 2026 6:20:03pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "SincResamplingSource.h"
+
+#if JUCE_INTEL
+ #include <xmmintrin.h>
+#elif JUCE_ARM && defined (__ARM_NEON)
+ #include <arm_neon.h>
+#endif
+
+// https://ccrma.stanford.edu/~jos/resample/ <-- bandlimited interpolation, kaiser windowed sinc
+
+namespace
+{
+    // kernel shape per quality tier
+    struct Tier
+    {
+        int taps;
+        int phases;
+        double cutoff; // fraction of nyquist kept
+        double beta;   // kaiser window
+    };
+
+    constexpr Tier tiers[3] = {
+        { 8,  32,  0.85, 5.0 },  // low
+        { 16, 64,  0.90, 7.0 },  // medium
+        { 32, 128, 0.94, 9.0 },  // high
+    };
+
+    // zeroth order modified bessel function, for the kaiser window
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (x * 0.5 / k) * (x * 0.5 / k);
+            sum += term;
+            if (term < sum * 1.0e-12) break;
+        }
+        return sum;
+    }
+
+    double kaiser(double u, double beta)
+    {
+        if (std::abs(u) > 1.0) return 0.0;
+        return besselI0(beta * std::sqrt(1.0 - u * u)) / besselI0(beta);
+    }
+
+    double sinc(double x)
+    {
+        if (std::abs(x) < 1.0e-9) return 1.0;
+        const double px = juce::MathConstants<double>::pi * x;
+        return std::sin(px) / px;
+    }
+}
+
+// kernels for every tier and stretch factor
+struct SincResamplingSource::KernelSet
+{
+    // kernels are stretched by the smallest bucket >= ratio
+    static constexpr int numBuckets = 7;
+    static constexpr double buckets[numBuckets] = { 1.0, 1.25, 1.5, 2.0, 2.5, 3.0, 4.0 };
+
+    Kernel tables[3][numBuckets];
+    int maxTaps{ 0 };
+
+    KernelSet()
+    {
+        for (int t = 0; t < 3; ++t)
+        {
+            for (int b = 0; b < numBuckets; ++b)
+            {
+                tables[t][b] = build(tiers[t], buckets[b]);
+                maxTaps = juce::jmax(maxTaps, tables[t][b].numTaps);
+            }
+        }
+    }
+
+    static Kernel build(const Tier& tier, double stretch)
+    {
+        Kernel k;
+
+        // multiple of 4 for the SIMD loop
+        k.numTaps = ((int)std::ceil(tier.taps * stretch) + 3) & ~3;
+        k.numPhases = tier.phases;
+        k.coeffs.resize((size_t)(k.numPhases + 1) * (size_t)k.numTaps);
+
+        const int half = k.numTaps / 2;
+        const double cutoff = tier.cutoff / stretch;
+
+        for (int p = 0; p <= k.numPhases; ++p)
+        {
+            const double frac = (double)p / (double)k.numPhases;
+            float* row = k.coeffs.data() + (size_t)p * (size_t)k.numTaps;
+            double sum = 0.0;
+
+            // tap i sits at input index centre - (half - 1) + i
+            for (int i = 0; i < k.numTaps; ++i)
+            {
+                const double x = (double)(i - (half - 1)) - frac;
+                const double h = cutoff * sinc(cutoff * x) * kaiser(x / half, tier.beta);
+                row[i] = (float)h;
+                sum += h;
+            }
+
+            // unity gain at dc for every phase
+            for (int i = 0; i < k.numTaps; ++i)
+                row[i] = (float)(row[i] / sum);
+        }
+
+        return k;
+    }
+};
+
+const SincResamplingSource::KernelSet& SincResamplingSource::getKernels()
+{
+    static const KernelSet set;
+    return set;
+}
+
+SincResamplingSource::SincResamplingSource(juce::AudioSource* in, int channels)
+    : input(in),
+      numChannels(juce::jmax(1, channels)),
+      kernels(getKernels())
+{
+    jassert(input != nullptr);
+
+    // enough history behind the read position for the longest kernel
+    lookback = kernels.maxTaps / 2;
+}
+
+void SincResamplingSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    maxBlock = juce::jmax(16, samplesPerBlockExpected);
+
+    // one chunk at the fastest ratio plus the kernel on either side
+    const int capacity = lookback + (int)std::ceil(maxBlock * maxRatio) + kernels.maxTaps + 8;
+    history.setSize(numChannels, capacity);
+    history.clear();
+
+    // silence behind the first sample, the first output lands exactly on input sample 0
+    historyLength = lookback;
+    readPos = (double)lookback;
+    ratioPrimed = false;
+
+    input->prepareToPlay(samplesPerBlockExpected, sampleRate);
+}
+
+void SincResamplingSource::releaseResources()
+{
+    input->releaseResources();
+}
+
+void SincResamplingSource::setResamplingRatio(double samplesInPerOutputSample)
+{
+    targetRatio = juce::jlimit(0.0, maxRatio, samplesInPerOutputSample);
+
+    // the very first ratio is used as is rather than glided to
+    if (!ratioPrimed)
+    {
+        currentRatio = targetRatio;
+        ratioPrimed = true;
+    }
+}
+
+void SincResamplingSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+{
+    if (info.numSamples <= 0) return;
+
+    // spread ratio changes over the whole block
+    const double ratioStep = (targetRatio - currentRatio) / (double)info.numSamples;
+
+    int done = 0;
+    while (done < info.numSamples)
+    {
+        const int num = juce::jmin(maxBlock, info.numSamples - done);
+        renderChunk(*info.buffer, info.startSample + done, num, ratioStep);
+        done += num;
+    }
+
+    currentRatio = targetRatio;
+}
+
+const SincResamplingSource::Kernel& SincResamplingSource::pickKernel(int tier, double ratio) const
+{
+    const int t = juce::jlimit(0, 2, tier);
+
+    for (int b = 0; b < KernelSet::numBuckets; ++b)
+    {
+        if (ratio <= KernelSet::buckets[b])
+            return kernels.tables[t][b];
+    }
+
+    // faster than the widest kernel, alias a little rather than cost more
+    return kernels.tables[t][KernelSet::numBuckets - 1];
+}
+
+void SincResamplingSource::renderChunk(juce::AudioBuffer<float>& out, int startSample, int num, double ratioStep)
+{
+    const double endRatio = currentRatio + ratioStep * num;
+    const double maxChunkRatio = juce::jmax(currentRatio, endRatio);
+
+    const Kernel& k = pickKernel(quality.load(std::memory_order_relaxed), maxChunkRatio);
+    const int half = k.numTaps / 2;
+
+    // input needed up to the last tap of the last output sample
+    const int needed = (int)std::ceil(readPos + maxChunkRatio * num) + half + 1;
+    if (needed > historyLength)
+        pullInput(needed - historyLength);
+
+    const int outChannels = out.getNumChannels();
+
+    for (int i = 0; i < num; ++i)
+    {
+        const int centre = (int)readPos;
+        const double phasePos = (readPos - centre) * k.numPhases;
+        const int phase = (int)phasePos;
+        const float blend = (float)(phasePos - phase);
+
+        const float* row0 = k.coeffs.data() + (size_t)phase * (size_t)k.numTaps;
+        const float* row1 = row0 + k.numTaps;
+        const int base = centre - (half - 1);
+
+        for (int ch = 0; ch < outChannels; ++ch)
+        {
+            const float* src = history.getReadPointer(juce::jmin(ch, numChannels - 1)) + base;
+
+            // interpolate between the two nearest phases
+            const float a = dotProduct(src, row0, k.numTaps);
+            const float b = dotProduct(src, row1, k.numTaps);
+            out.setSample(ch, startSample + i, a + blend * (b - a));
+        }
+
+        readPos += currentRatio;
+        currentRatio += ratioStep;
+    }
+
+    // drop input that no kernel can reach any more
+    const int drop = (int)readPos - lookback;
+    if (drop > 0)
+    {
+        const int keep = historyLength - drop;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* data = history.getWritePointer(ch);
+            std::memmove(data, data + drop, (size_t)keep * sizeof(float));
+        }
+
+        historyLength = keep;
+        readPos -= drop;
+    }
+}
+
+void SincResamplingSource::pullInput(int numSamples)
+{
+    numSamples = juce::jmin(numSamples, history.getNumSamples() - historyLength);
+    if (numSamples <= 0) return;
+
+    juce::AudioSourceChannelInfo info(&history, historyLength, numSamples);
+    input->getNextAudioBlock(info);
+    historyLength += numSamples;
+}
+
+float SincResamplingSource::dotProduct(const float* a, const float* b, int n) noexcept
+{
+   #if JUCE_INTEL
+    __m128 acc = _mm_setzero_ps();
+    for (int i = 0; i < n; i += 4)
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+
+    // horizontal sum
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    return _mm_cvtss_f32(acc);
+   #elif JUCE_ARM && defined (__ARM_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (int i = 0; i < n; i += 4)
+        acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+
+    const float32x2_t pair = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    return vget_lane_f32(vpadd_f32(pair, pair), 0);
+   #else
+    // four running sums so the compiler can still vectorise
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    for (int i = 0; i < n; i += 4)
+    {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    return (s0 + s1) + (s2 + s3);
+   #endif
+}
@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    SincResamplingSource.h
+    Created: 17 Oct 2026 6:20:03pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// single stage polyphase windowed-sinc resampler
+// the deck feeds it file rate / device rate * speed, so one pass does both the
+// sample rate conversion and the tempo change
+// kernels are stretched when downsampling so fast playback does not alias
+class SincResamplingSource : public juce::AudioSource
+{
+public:
+    // low: 8 taps, medium: 16 taps, high: 32 taps (before stretching)
+    enum class Quality { low = 0, medium, high };
+
+    // input is not owned
+    SincResamplingSource(juce::AudioSource* input, int numChannels = 2);
+    ~SincResamplingSource() override = default;
+
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    // input samples per output sample, glides there over the next block
+    // audio thread only
+    void setResamplingRatio(double samplesInPerOutputSample);
+    double getResamplingRatio() const { return targetRatio; }
+
+    // audio thread: input pulled but not yet under the next output sample
+    double getBufferedInputSamples() const { return (double)historyLength - readPos; }
+
+    // any thread, kernels for every tier are built up front
+    void setQuality(Quality q) { quality.store((int)q, std::memory_order_relaxed); }
+    Quality getQuality() const { return (Quality)quality.load(std::memory_order_relaxed); }
+
+    // fastest supported playback, higher ratios are clamped
+    static constexpr double maxRatio = 8.0;
+
+private:
+    // one polyphase table: numPhases + 1 rows of numTaps coefficients
+    // the extra row lets us interpolate between neighbouring phases
+    struct Kernel
+    {
+        int numTaps{ 0 };
+        int numPhases{ 0 };
+        std::vector<float> coeffs;
+    };
+
+    // kernels only depend on the ratio, so every deck shares one set
+    struct KernelSet;
+    static const KernelSet& getKernels();
+
+    const Kernel& pickKernel(int tier, double ratio) const;
+
+    // render one chunk of at most maxBlock output samples
+    void renderChunk(juce::AudioBuffer<float>& out, int startSample, int numSamples, double ratioStep);
+
+    // append input samples to the history
+    void pullInput(int numSamples);
+
+    // SIMD dot product, n is always a multiple of 4
+    static float dotProduct(const float* a, const float* b, int n) noexcept;
+
+    juce::AudioSource* input;
+    const int numChannels;
+    const KernelSet& kernels;
+
+    // past and upcoming input, readPos is the centre of the next output sample
+    juce::AudioBuffer<float> history;
+    int historyLength{ 0 };
+    int lookback{ 0 };
+    double readPos{ 0.0 };
+    int maxBlock{ 0 };
+
+    double currentRatio{ 1.0 };
+    double targetRatio{ 1.0 };
+    bool ratioPrimed{ false };
+
+    std::atomic<int> quality{ (int)Quality::medium };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SincResamplingSource)
+};
@@ -0,0 +1,238 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.cpp
+    Created: 18 Oct 2026 3:34:02am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "SpectrumAnalyser.h"
+
+namespace
+{
+    // sum of a run of floats, SIMD over the aligned middle
+    float sumOf(const float* data, int num)
+    {
+        float total = 0.0f;
+
+       #if JUCE_USE_SIMD
+        using Reg = juce::dsp::SIMDRegister<float>;
+
+        for (; num > 0 && !Reg::isSIMDAligned(data); --num)
+            total += *data++;
+
+        auto acc = Reg::expand(0.0f);
+        for (; num >= (int)Reg::size(); num -= (int)Reg::size(), data += Reg::size())
+            acc += Reg::fromRawArray(data);
+
+        total += acc.sum();
+       #endif
+
+        for (; num > 0; --num)
+            total += *data++;
+
+        return total;
+    }
+}
+
+//==============================================================================
+SpectrumTap::SpectrumTap(int fftOrder)
+    : requestedOrder(juce::jlimit(minOrder, maxOrder, fftOrder))
+{
+    fifoData.resize((size_t)fifo.getTotalSize(), 0.0f);
+}
+
+void SpectrumTap::push(const juce::AudioBuffer<float>& buffer, int start, int num)
+{
+    const int numChans = buffer.getNumChannels();
+    if (!isActive() || numChans <= 0) return;
+
+    // a full fifo means the worker is stalled, drop audio rather than wait
+    const auto scope = fifo.write(juce::jmin(num, fifo.getFreeSpace()));
+    const float scale = 1.0f / (float)numChans;
+
+    // average channels
+    auto mixdown = [&](int fifoIndex, int count, int offset)
+        {
+            if (count <= 0) return;
+
+            float* dest = fifoData.data() + fifoIndex;
+            juce::FloatVectorOperations::multiply(dest, buffer.getReadPointer(0, start + offset), scale, count);
+            for (int c = 1; c < numChans; ++c)
+                juce::FloatVectorOperations::addWithMultiply(dest, buffer.getReadPointer(c, start + offset), scale, count);
+        };
+
+    mixdown(scope.startIndex1, scope.blockSize1, 0);
+    mixdown(scope.startIndex2, scope.blockSize2, scope.blockSize1);
+}
+
+void SpectrumTap::updateBands()
+{
+    const int nSpec = (1 << order) / 2;
+    bands.resize((size_t)numBands);
+
+    // log spaced: each band covers the next slice of 10^t, t from 0 to 1
+    for (int b = 0; b < numBands; ++b)
+    {
+        const float t0 = (float)b / (float)numBands;
+        const float t1 = (float)(b + 1) / (float)numBands;
+        const int i0 = (int)std::floor(std::pow(10.0f, t0) / 10.0f * nSpec);
+        const int i1 = (int)std::floor(std::pow(10.0f, t1) / 10.0f * nSpec);
+
+        const int first = juce::jlimit(0, nSpec - 1, i0);
+        const int count = juce::jlimit(1, nSpec - first, i1 - i0);
+        bands[(size_t)b] = { first, count };
+    }
+}
+
+void SpectrumTap::analyse(int fftOrder, juce::dsp::FFT& fft, const std::vector<float>& window, float* bins)
+{
+    // device restarted: drop what was queued and start from silence
+    if (resetRequested.exchange(false, std::memory_order_acquire))
+    {
+        fifo.read(fifo.getNumReady());
+        std::fill(history.begin(), history.end(), 0.0f);
+        newSamples = 0;
+
+        for (auto& level : bandLevels)
+            level.store(0.0f, std::memory_order_relaxed);
+    }
+
+    // size or band count changed since the last pass
+    if (fftOrder != order)
+    {
+        order = fftOrder;
+        history.assign((size_t)1 << order, 0.0f);
+        newSamples = 0;
+        numBands = 0;
+    }
+
+    const int wantBands = requestedBands.load();
+    if (wantBands != numBands)
+    {
+        numBands = wantBands;
+        updateBands();
+    }
+
+    const int size = 1 << order;
+
+    const int ready = fifo.getNumReady();
+    if (ready <= 0) return;
+
+    // keep only the newest size samples, slide the history along
+    const int take = juce::jmin(ready, size);
+    fifo.read(ready - take);
+    std::memmove(history.data(), history.data() + take, (size_t)(size - take) * sizeof(float));
+
+    {
+        const auto scope = fifo.read(take);
+        float* dest = history.data() + (size - take);
+        std::memcpy(dest, fifoData.data() + scope.startIndex1, (size_t)scope.blockSize1 * sizeof(float));
+        std::memcpy(dest + scope.blockSize1, fifoData.data() + scope.startIndex2, (size_t)scope.blockSize2 * sizeof(float));
+    }
+
+    // wait for a full window
+    newSamples = juce::jmin(size, newSamples + ready);
+    if (newSamples < size) return;
+
+    // window while copying in, upper half zero for the real-only transform
+    juce::FloatVectorOperations::multiply(bins, history.data(), window.data(), size);
+    juce::FloatVectorOperations::clear(bins + size, size);
+    fft.performRealOnlyForwardTransform(bins, true);
+
+    // squares of re, im interleaved: a band's power is one contiguous run, no sqrt per bin
+    juce::FloatVectorOperations::multiply(bins, bins, size);
+
+    // same look whatever the fft size
+    const float norm = 1024.0f / (float)size;
+
+    for (int b = 0; b < numBands; ++b)
+    {
+        const auto [first, count] = bands[(size_t)b];
+        const float power = sumOf(bins + first * 2, count * 2) / (float)count;
+
+        // rms magnitude of the band, to a normalized 0-1
+        const float v = std::sqrt(power) * norm;
+        bandLevels[(size_t)b].store(juce::jlimit(0.0f, 1.0f, std::log10(1.0f + v * 8.0f)), std::memory_order_relaxed);
+    }
+}
+
+//==============================================================================
+SpectrumWorker::Plan::Plan(int order)
+    : fft(order),
+      window((size_t)1 << order)
+{
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), window.size(),
+                                                            juce::dsp::WindowingFunction<float>::hann);
+}
+
+SpectrumWorker::SpectrumWorker(bool runThread)
+    : juce::Thread("Spectrum")
+{
+    // room for the biggest transform plus alignment slack
+    scratchStorage.calloc((size_t)(2 << SpectrumTap::maxOrder) * sizeof(float) + 64);
+    scratch = reinterpret_cast<float*>(scratchStorage.get());
+
+   #if JUCE_USE_SIMD
+    scratch = juce::dsp::SIMDRegister<float>::getNextSIMDAlignedPtr(scratch);
+   #endif
+
+    if (runThread)
+        startThread(juce::Thread::Priority::low);
+}
+
+SpectrumWorker::~SpectrumWorker()
+{
+    stopThread(1000);
+}
+
+void SpectrumWorker::addTap(SpectrumTap* tap)
+{
+    const juce::ScopedLock sl(lock);
+    taps.addIfNotAlreadyThere(tap);
+}
+
+void SpectrumWorker::removeTap(SpectrumTap* tap)
+{
+    // waits out a pass that may be using it
+    const juce::ScopedLock sl(lock);
+    taps.removeFirstMatchingValue(tap);
+}
+
+SpectrumWorker::Plan& SpectrumWorker::getPlan(int order)
+{
+    auto& plan = plans[order];
+    if (plan == nullptr)
+        plan = std::make_unique<Plan>(order);
+
+    return *plan;
+}
+
+void SpectrumWorker::analyseAll()
+{
+    const juce::ScopedLock sl(lock);
+
+    // every visible tap in one pass, sharing plans and scratch
+    for (auto* tap : taps)
+    {
+        if (!tap->isActive()) continue;
+
+        const int order = tap->requestedOrder.load();
+        auto& plan = getPlan(order);
+        tap->analyse(order, plan.fft, plan.window, scratch);
+    }
+}
+
+void SpectrumWorker::run()
+{
+    while (!threadShouldExit())
+    {
+        analyseAll();
+
+        // 60 Hz
+        wait(16);
+    }
+}
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.h
+    Created: 18 Oct 2026 3:34:02am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <juce_dsp/juce_dsp.h>
+
+// https://docs.juce.com/master/classdsp_1_1FFT.html <-- documentation used
+// https://docs.juce.com/master/structdsp_1_1SIMDRegister.html <-- documentation used
+
+// one point in the signal chain to analyse (a deck before / after its fx, the master)
+// the audio thread only mixes to mono into a lock-free fifo, and only while someone is looking
+// band levels come back from the SpectrumWorker through atomics
+class SpectrumTap
+{
+public:
+    // fft size is 1 << order
+    explicit SpectrumTap(int fftOrder = 10);
+
+    static constexpr int minOrder = 8;
+    static constexpr int maxOrder = 13;
+    static constexpr int maxBands = 64;
+
+    // audio thread
+    void push(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    // any thread, picked up by the worker before its next transform
+    void setOrder(int fftOrder) { requestedOrder.store(juce::jlimit(minOrder, maxOrder, fftOrder)); }
+    void setNumBands(int n) { requestedBands.store(juce::jlimit(1, maxBands, n)); }
+
+    // any thread (prepareToPlay): forget the audio so far
+    // the worker applies it before its next transform, it owns the history and the fifo's read side
+    void reset() { resetRequested.store(true, std::memory_order_release); }
+
+    // displays switch this on while they are showing, inactive taps cost nothing
+    void setActive(bool shouldBeActive) { active.store(shouldBeActive, std::memory_order_relaxed); }
+    bool isActive() const { return active.load(std::memory_order_relaxed); }
+
+    // 0..1, the latest transform
+    float getBandLevel(int band) const { return bandLevels[(size_t)band].load(std::memory_order_relaxed); }
+
+private:
+    friend class SpectrumWorker;
+
+    // worker thread: drain the fifo, transform the newest window, reduce to bands
+    // fft and window are for fftOrder, bins is SIMD aligned scratch shared by every tap
+    void analyse(int fftOrder, juce::dsp::FFT& fft, const std::vector<float>& window, float* bins);
+
+    // log spaced band edges for the current size and band count
+    void updateBands();
+
+    // audio -> worker, single producer / single consumer, big enough for the largest order
+    juce::AbstractFifo fifo{ 4 << maxOrder };
+    std::vector<float> fifoData;
+
+    std::atomic<bool> active{ false };
+    std::atomic<bool> resetRequested{ false };
+    std::atomic<int> requestedOrder;
+    std::atomic<int> requestedBands{ 16 };
+
+    // worker thread state
+    int order{ 0 };
+    int numBands{ 0 };
+    std::vector<float> history;       // newest fftSize samples, oldest first
+    int newSamples{ 0 };
+    std::vector<std::pair<int, int>> bands;   // first bin, bin count
+
+    std::array<std::atomic<float>, maxBands> bandLevels{};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumTap)
+};
+
+// one thread analyses every tap at 60 Hz in a single pass
+// taps of the same order share the fft plan, the window and the scratch buffer
+class SpectrumWorker : private juce::Thread
+{
+public:
+    // benchmarks pass false and call analyseAll themselves
+    explicit SpectrumWorker(bool runThread = true);
+    ~SpectrumWorker() override;
+
+    // message thread, remove a tap before it is destroyed
+    void addTap(SpectrumTap* tap);
+    void removeTap(SpectrumTap* tap);
+
+    // one pass over every active tap, the thread runs it at 60 Hz
+    void analyseAll();
+
+private:
+    void run() override;
+
+    struct Plan
+    {
+        explicit Plan(int order);
+
+        juce::dsp::FFT fft;
+        std::vector<float> window;
+    };
+
+    Plan& getPlan(int order);
+
+    juce::CriticalSection lock;
+    juce::Array<SpectrumTap*> taps;
+
+    // worker thread only
+    std::map<int, std::unique_ptr<Plan>> plans;
+    juce::HeapBlock<char> scratchStorage;
+    float* scratch{ nullptr };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumWorker)
+};
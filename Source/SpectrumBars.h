@@ -12,47 +12,44 @@
 
 #include <JuceHeader.h>
 
+#include "SpectrumAnalyser.h"
+
 /* Docs: https://juce.com/tutorials/tutorial_spectrum_analyser/ <-- documentation used
 */
+// draws the bands of one SpectrumTap, the analysis itself runs on the SpectrumWorker
 class SpectrumBars : public juce::Component, private juce::Timer
 {
 public:
-    SpectrumBars(int fftOrder = 10, int numBars = 16);
-    ~SpectrumBars() override = default;
+    SpectrumBars(int numBars = 16);
+    ~SpectrumBars() override;
 
-    void prepare(double sampleRate);
-    void pushAudioBlock(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    // tap to draw, nullptr for none; kept active while this is on screen
+    void setTap(SpectrumTap* newTap);
 
     void setNumBars(int n);  
     void setDecay(float perSecond); 
 
+    // small label in the corner (which tap this is)
+    void setCaption(const juce::String& text) { caption = text; repaint(); }
+
+    std::function<void()> onClick;
+
     void paint(juce::Graphics& g) override;
     void resized() override {}
+    void mouseDown(const juce::MouseEvent&) override { if (onClick) onClick(); }
 
 private:
     void timerCallback() override;
-    void runFFTIfReady();
 
     // config
-    const int fftOrder;
-    const int fftSize;
     int bars;
     float decayPerSec = 3.0f;
 
-    // fourier
-    juce::dsp::FFT fft;
-    juce::dsp::WindowingFunction<float> window;
-    juce::AudioBuffer<float> monoFifo;
-    std::atomic<int> fifoFill{ 0 }; 
+    SpectrumTap* tap{ nullptr };
+    juce::String caption;
 
-    // work buffers
-    std::vector<float> fftInput;
-    std::vector<float> fftBuffer;        
-    std::vector<float> mag;             
+    // held levels, decayed every frame
     std::vector<float> barLevels; 
 
-    // helper to mixdown to mono and push into fifo
-    void pushMono(const float* const* chans, int numChans, int num, int start);
-
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumBars)
 };
@@ -0,0 +1,258 @@
+/*
+  ==============================================================================
+
+    StereoDelay.cpp
+    Created: 17 Oct 2026 10:05:18pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "StereoDelay.h"
+
+// https://docs.juce.com/master/namespaceFloatVectorOperations.html <-- documentation used
+
+namespace
+{
+    // dest = src * gain, gain moving linearly from a to b over the segment
+    void scaleInto(float* dest, const float* src, float a, float b, int n)
+    {
+        if (a == b)
+        {
+            juce::FloatVectorOperations::multiply(dest, src, a, n);
+            return;
+        }
+
+        const float step = (b - a) / (float)n;
+        for (int i = 0; i < n; ++i)
+            dest[i] = src[i] * (a + step * (float)i);
+    }
+
+    // dest += src * gain, same ramp as above
+    void addScaled(float* dest, const float* src, float a, float b, int n)
+    {
+        if (a == b)
+        {
+            juce::FloatVectorOperations::addWithMultiply(dest, src, a, n);
+            return;
+        }
+
+        const float step = (b - a) / (float)n;
+        for (int i = 0; i < n; ++i)
+            dest[i] += src[i] * (a + step * (float)i);
+    }
+
+    float peakOf(const float* data, int n)
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax(data, n);
+        return juce::jmax(-range.getStart(), range.getEnd());
+    }
+}
+
+void StereoDelay::prepare(double newSampleRate, int maxBlockSize, double maxDelaySeconds)
+{
+    sampleRate = newSampleRate;
+    maxDelay = juce::jmax(16, (int)std::ceil(maxDelaySeconds * sampleRate));
+    maxSegment = juce::jmax(16, maxBlockSize);
+
+    ring.setSize(2, juce::nextPowerOfTwo(maxDelay + maxSegment + 1));
+    ringMask = ring.getNumSamples() - 1;
+
+    tap.setSize(2, maxSegment);
+    oldTap.setSize(2, maxSegment);
+    written.setSize(2, maxSegment);
+    ramp.assign((size_t)maxSegment, 0.0f);
+
+    // 10ms crossfade whenever the delay time moves
+    fadeLength = juce::jmax(1, (int)(0.01 * sampleRate));
+
+    feedback.reset(sampleRate, 0.02);
+    mix.reset(sampleRate, 0.02);
+    send.reset(sampleRate, 0.02);
+
+    // repeats lose highs above ~5kHz and rumble below ~120Hz
+    const double twoPi = juce::MathConstants<double>::twoPi;
+    lowCoeff = (float)(1.0 - std::exp(-twoPi * 5000.0 / sampleRate));
+    highCoeff = (float)(1.0 - std::exp(-twoPi * 120.0 / sampleRate));
+
+    reset();
+}
+
+void StereoDelay::reset()
+{
+    ring.clear();
+    writePos = 0;
+
+    currentDelay = fadeFromDelay = targetDelay;
+    fadeDone = 0;
+
+    for (int ch = 0; ch < 2; ++ch)
+        lowState[ch] = highState[ch] = 0.0f;
+
+    feedback.setCurrentAndTargetValue(0.0f);
+    mix.setCurrentAndTargetValue(0.0f);
+    send.setCurrentAndTargetValue(0.0f);
+}
+
+void StereoDelay::setDelaySeconds(double seconds)
+{
+    targetDelay = juce::jlimit(16, maxDelay, juce::roundToInt(seconds * sampleRate));
+}
+
+void StereoDelay::setFeedback(float amount) { feedback.setTargetValue(juce::jlimit(0.0f, 0.95f, amount)); }
+void StereoDelay::setMix(float amount) { mix.setTargetValue(juce::jlimit(0.0f, 1.0f, amount)); }
+void StereoDelay::setSend(float amount) { send.setTargetValue(juce::jlimit(0.0f, 1.0f, amount)); }
+
+float StereoDelay::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    float* left = buffer.getWritePointer(0, startSample);
+
+    // mono buffers run the right side on scratch and throw it away
+    const bool mono = buffer.getNumChannels() < 2;
+    float* right = mono ? nullptr : buffer.getWritePointer(1, startSample);
+
+    float peak = 0.0f;
+    int done = 0;
+
+    while (done < numSamples)
+    {
+        // start a new crossfade once the last one has finished
+        if (fadeFromDelay == currentDelay && targetDelay != currentDelay)
+        {
+            fadeFromDelay = currentDelay;
+            currentDelay = targetDelay;
+            fadeDone = 0;
+        }
+
+        const int num = juce::jmin(numSamples - done, maxSegment, juce::jmin(currentDelay, fadeFromDelay));
+
+        float* segmentRight = right != nullptr ? right + done : written.getWritePointer(1);
+        if (mono)
+            juce::FloatVectorOperations::copy(segmentRight, left + done, num);
+
+        peak = juce::jmax(peak, processSegment(left + done, segmentRight, num));
+        done += num;
+    }
+
+    return peak;
+}
+
+float StereoDelay::processSegment(float* left, float* right, int num)
+{
+    float* tapL = tap.getWritePointer(0);
+    float* tapR = tap.getWritePointer(1);
+
+    readTap(currentDelay, tapL, tapR, num);
+
+    // blend in from the previous delay time
+    if (fadeFromDelay != currentDelay)
+    {
+        float* oldL = oldTap.getWritePointer(0);
+        float* oldR = oldTap.getWritePointer(1);
+        readTap(fadeFromDelay, oldL, oldR, num);
+
+        for (int i = 0; i < num; ++i)
+            ramp[(size_t)i] = juce::jmin(1.0f, (float)(fadeDone + i + 1) / (float)fadeLength);
+
+        // tap = old + (tap - old) * ramp
+        juce::FloatVectorOperations::subtract(tapL, oldL, num);
+        juce::FloatVectorOperations::subtract(tapR, oldR, num);
+        juce::FloatVectorOperations::multiply(tapL, ramp.data(), num);
+        juce::FloatVectorOperations::multiply(tapR, ramp.data(), num);
+        juce::FloatVectorOperations::add(tapL, oldL, num);
+        juce::FloatVectorOperations::add(tapR, oldR, num);
+
+        fadeDone += num;
+        if (fadeDone >= fadeLength)
+            fadeFromDelay = currentDelay;
+    }
+
+    // feedback filters, the only part that has to run sample by sample
+    // both channels in one loop so their recursions overlap
+    {
+        float lpL = lowState[0], hpL = highState[0];
+        float lpR = lowState[1], hpR = highState[1];
+
+        for (int i = 0; i < num; ++i)
+        {
+            lpL += lowCoeff * (tapL[i] - lpL);
+            lpR += lowCoeff * (tapR[i] - lpR);
+            hpL += highCoeff * (lpL - hpL);
+            hpR += highCoeff * (lpR - hpR);
+            tapL[i] = lpL - hpL;
+            tapR[i] = lpR - hpR;
+        }
+
+        lowState[0] = lpL; highState[0] = hpL;
+        lowState[1] = lpR; highState[1] = hpR;
+    }
+
+    // gains for this segment
+    const float sendA = send.getCurrentValue(), sendB = send.skip(num);
+    const float fbA = feedback.getCurrentValue(), fbB = feedback.skip(num);
+    const float mixA = mix.getCurrentValue(), mixB = mix.skip(num);
+
+    float* writeL = written.getWritePointer(0);
+    float* writeR = oldTap.getWritePointer(0); // free again after the crossfade
+
+    if (mode == Mode::pingPong)
+    {
+        // input enters on the left and bounces across
+        juce::FloatVectorOperations::add(writeL, left, right, num);
+        scaleInto(writeL, writeL, 0.5f * sendA, 0.5f * sendB, num);
+        addScaled(writeL, tapR, fbA, fbB, num);
+        scaleInto(writeR, tapL, fbA, fbB, num);
+    }
+    else
+    {
+        scaleInto(writeL, left, sendA, sendB, num);
+        addScaled(writeL, tapL, fbA, fbB, num);
+        scaleInto(writeR, right, sendA, sendB, num);
+        addScaled(writeR, tapR, fbA, fbB, num);
+    }
+
+    write(writeL, writeR, num);
+
+    // dry is only ducked while new audio goes in
+    scaleInto(left, left, 1.0f - mixA * sendA, 1.0f - mixB * sendB, num);
+    scaleInto(right, right, 1.0f - mixA * sendA, 1.0f - mixB * sendB, num);
+    addScaled(left, tapL, mixA, mixB, num);
+    addScaled(right, tapR, mixA, mixB, num);
+
+    const float wetPeak = juce::jmax(peakOf(tapL, num), peakOf(tapR, num)) * juce::jmax(mixA, mixB);
+    return juce::jmax(wetPeak, peakOf(writeL, num), peakOf(writeR, num));
+}
+
+void StereoDelay::readTap(int delaySamples, float* destLeft, float* destRight, int num) const
+{
+    const int size = ring.getNumSamples();
+    const int start = (writePos - delaySamples) & ringMask;
+    const int first = juce::jmin(num, size - start);
+
+    juce::FloatVectorOperations::copy(destLeft, ring.getReadPointer(0, start), first);
+    juce::FloatVectorOperations::copy(destRight, ring.getReadPointer(1, start), first);
+
+    if (first < num)
+    {
+        juce::FloatVectorOperations::copy(destLeft + first, ring.getReadPointer(0), num - first);
+        juce::FloatVectorOperations::copy(destRight + first, ring.getReadPointer(1), num - first);
+    }
+}
+
+void StereoDelay::write(const float* left, const float* right, int num)
+{
+    const int size = ring.getNumSamples();
+    const int first = juce::jmin(num, size - writePos);
+
+    juce::FloatVectorOperations::copy(ring.getWritePointer(0, writePos), left, first);
+    juce::FloatVectorOperations::copy(ring.getWritePointer(1, writePos), right, first);
+
+    if (first < num)
+    {
+        juce::FloatVectorOperations::copy(ring.getWritePointer(0), left + first, num - first);
+        juce::FloatVectorOperations::copy(ring.getWritePointer(1), right + first, num - first);
+    }
+
+    writePos = (writePos + num) & ringMask;
+}
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    StereoDelay.h
+    Created: 17 Oct 2026 10:05:18pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// block based stereo / ping-pong echo
+// one ring buffer per channel, read and written in contiguous segments with
+// FloatVectorOperations instead of a push/pop per sample
+// delay time is whole samples, changes crossfade between the old and new tap
+// repeats go through a one pole high + low pass so they darken and thin out
+class StereoDelay
+{
+public:
+    enum class Mode { stereo = 0, pingPong };
+
+    StereoDelay() = default;
+
+    void prepare(double sampleRate, int maxBlockSize, double maxDelaySeconds);
+
+    // clears the line, gains restart from 0 and the delay time snaps to its target
+    void reset();
+
+    // audio thread, all of these are smoothed / crossfaded
+    void setDelaySeconds(double seconds);
+    void setFeedback(float amount);
+    void setMix(float amount);
+    void setSend(float amount);   // how much input goes in, 0 lets the echoes fade out
+    void setMode(Mode newMode) { mode = newMode; }
+
+    // in place, returns the loudest echo heard or written back
+    float process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    double getDelaySeconds() const { return targetDelay / sampleRate; }
+
+private:
+    // one segment no longer than the shortest tap, so nothing is read before it is written
+    float processSegment(float* left, float* right, int numSamples);
+
+    // copy numSamples from delay samples back into dest, across the wrap
+    void readTap(int delaySamples, float* destLeft, float* destRight, int numSamples) const;
+    void write(const float* left, const float* right, int numSamples);
+
+    double sampleRate{ 44100.0 };
+    Mode mode{ Mode::stereo };
+
+    // ring buffers, power of two so wrapping is a mask
+    juce::AudioBuffer<float> ring;
+    int ringMask{ 0 };
+    int writePos{ 0 };
+    int maxDelay{ 1 };
+    int maxSegment{ 0 };
+
+    // delay time and the crossfade away from the previous one
+    int currentDelay{ 1 };
+    int targetDelay{ 1 };
+    int fadeFromDelay{ 1 };
+    int fadeDone{ 0 };
+    int fadeLength{ 441 };
+
+    juce::SmoothedValue<float> feedback, mix, send;
+
+    // feedback path filters, per channel
+    float lowCoeff{ 0.0f }, highCoeff{ 0.0f };
+    float lowState[2]{}, highState[2]{};
+
+    // scratch for one segment
+    juce::AudioBuffer<float> tap, oldTap, written;
+    std::vector<float> ramp;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StereoDelay)
+};
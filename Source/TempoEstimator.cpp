@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    TempoEstimator.cpp
+    Created: 17 Oct 2026 10:41:56pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TempoEstimator.h"
+
+// https://docs.juce.com/master/classAudioFormatReader.html <-- documentation used
+
+double TempoEstimator::estimate(juce::AudioFormatReader& reader, double maxSeconds, const std::function<bool()>& shouldStop)
+{
+    const double rate = reader.sampleRate;
+    if (rate <= 0.0 || reader.lengthInSamples <= 0) return 0.0;
+
+    // skip intros, most tracks have their beat going by then
+    const juce::int64 start = reader.lengthInSamples / 4;
+    const int total = (int)juce::jmin((juce::int64)(maxSeconds * rate), reader.lengthInSamples - start);
+    if (total <= 0) return 0.0;
+
+    std::vector<float> mono((size_t)total, 0.0f);
+    juce::AudioBuffer<float> chunk(2, 65536);
+
+    for (int done = 0; done < total;)
+    {
+        if (shouldStop != nullptr && shouldStop()) return 0.0;
+
+        const int num = juce::jmin(chunk.getNumSamples(), total - done);
+        reader.read(&chunk, 0, num, start + done, true, true);
+
+        juce::FloatVectorOperations::add(mono.data() + done, chunk.getReadPointer(0), chunk.getReadPointer(1), num);
+        done += num;
+    }
+
+    return estimate(mono.data(), total, rate);
+}
+
+double TempoEstimator::estimate(const float* mono, int numSamples, double sampleRate)
+{
+    // 5ms envelope frames
+    const int hop = juce::jmax(16, (int)(sampleRate * 0.005));
+    const double envelopeRate = sampleRate / hop;
+    const int frames = numSamples / hop;
+
+    const int minLag = (int)std::floor(envelopeRate * 60.0 / 200.0);
+    const int maxLag = (int)std::ceil(envelopeRate * 60.0 / 60.0);
+    if (frames < maxLag * 4) return 0.0;
+
+    // onset strength: rise in log energy from one frame to the next
+    std::vector<float> onset((size_t)frames, 0.0f);
+    float lastEnergy = 0.0f;
+    double mean = 0.0;
+
+    for (int f = 0; f < frames; ++f)
+    {
+        const float* frame = mono + (size_t)f * (size_t)hop;
+
+        float sum = 0.0f;
+        for (int i = 0; i < hop; ++i)
+            sum += frame[i] * frame[i];
+
+        const float energy = std::log(1.0f + 1000.0f * sum / (float)hop);
+        onset[(size_t)f] = juce::jmax(0.0f, energy - lastEnergy);
+        lastEnergy = energy;
+        mean += onset[(size_t)f];
+    }
+
+    juce::FloatVectorOperations::add(onset.data(), (float)(-mean / frames), frames);
+
+    // autocorrelation over 60..200 bpm
+    std::vector<double> score((size_t)maxLag + 2, 0.0);
+
+    for (int lag = minLag; lag <= maxLag + 1; ++lag)
+    {
+        double r = 0.0;
+        for (int f = 0; f + lag < frames; ++f)
+            r += onset[(size_t)f] * onset[(size_t)(f + lag)];
+
+        score[(size_t)lag] = r / (frames - lag);
+    }
+
+    // pick the strongest period, gently preferring ~120 bpm over its octaves
+    int best = 0;
+    double bestScore = 0.0;
+
+    for (int lag = minLag + 1; lag <= maxLag; ++lag)
+    {
+        const double bpm = 60.0 * envelopeRate / lag;
+        const double octaves = std::log2(bpm / 120.0);
+        const double weighted = score[(size_t)lag] * std::exp(-0.5 * octaves * octaves);
+
+        if (weighted > bestScore)
+        {
+            bestScore = weighted;
+            best = lag;
+        }
+    }
+
+    if (best == 0) return 0.0;
+
+    // parabolic fit for a fractional lag
+    const double a = score[(size_t)best - 1], b = score[(size_t)best], c = score[(size_t)best + 1];
+    const double denom = a - 2.0 * b + c;
+    const double shift = denom < 0.0 ? juce::jlimit(-0.5, 0.5, 0.5 * (a - c) / denom) : 0.0;
+
+    double bpm = 60.0 * envelopeRate / (best + shift);
+
+    while (bpm < minBpm) bpm *= 2.0;
+    while (bpm >= maxBpm) bpm *= 0.5;
+
+    return bpm;
+}
@@ -0,0 +1,33 @@
+/*
+  ==============================================================================
+
+    TempoEstimator.h
+    Created: 17 Oct 2026 10:41:56pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// rough bpm for tempo synced effects
+// autocorrelates an onset envelope and picks the strongest beat period,
+// leaning towards ~120 bpm and folded into 85..170
+// not a beat grid, just good enough to lock echoes to the groove
+class TempoEstimator
+{
+public:
+    // reads up to maxSeconds starting a quarter of the way into the track
+    // loader thread only, returns 0 when there is no clear beat
+    // shouldStop is asked between reads, returning true gives up with 0
+    static double estimate(juce::AudioFormatReader& reader, double maxSeconds = 30.0,
+                           const std::function<bool()>& shouldStop = nullptr);
+
+    // same on mono samples
+    static double estimate(const float* mono, int numSamples, double sampleRate);
+
+    static constexpr double minBpm = 85.0;
+    static constexpr double maxBpm = 170.0;
+};
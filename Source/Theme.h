@@ -45,6 +45,11 @@ namespace Theme {
     static const juce::Colour trackBase{ 0xFFDDA2A3 }; 
     static const juce::Colour trackStrong{ 0xFFCE79D2 }; 
 
+    // waveform, coloured by where the energy is
+    static const juce::Colour waveLow{ 0xFF3C42C4 };   // bass
+    static const juce::Colour waveMid{ 0xFFCE79D2 };   // mids
+    static const juce::Colour waveHigh{ 0xFFF4DFBE };  // highs
+
     // Text on dark vs on light 
     static const juce::Colour textOnDarkMain{ juce::Colours::white.withAlpha(0.92f) };
     static const juce::Colour textOnDarkMuted{ juce::Colours::white.withAlpha(0.65f) };
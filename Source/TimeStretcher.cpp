@@ -0,0 +1,401 @@
+/*
+  ==============================================================================
+
+    TimeStretcher.cpp
+    Created: 17 Oct 2026 8:02:37pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TimeStretcher.h"
+
+// Verhelst & Roelands 1993, "An overlap-add technique based on waveform similarity (WSOLA)"
+// Laroche & Dolson 1999, "Improved phase vocoder time-scale modification of audio" <-- identity phase locking
+// https://docs.juce.com/master/classdsp_1_1FFT.html <-- documentation used
+
+namespace
+{
+    float wrapPhase(float p)
+    {
+        const float twoPi = juce::MathConstants<float>::twoPi;
+        return p - twoPi * std::round(p / twoPi);
+    }
+}
+
+TimeStretcher::TimeStretcher(juce::AudioSource* in, int channels)
+    : input(in),
+      numChannels(juce::jmax(1, channels))
+{
+    jassert(input != nullptr);
+}
+
+void TimeStretcher::prepareToPlay(int samplesPerBlockExpected, double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    maxBlock = juce::jmax(16, samplesPerBlockExpected);
+
+    // two frames plus a hop at the fastest tempo covers the search window either side
+    const int inputCapacity = 2 * maxFrameSize + (int)std::ceil(maxFrameSize * maxTempo) + 16;
+    inputBuffer.setSize(numChannels, inputCapacity);
+    overlapAdd.setSize(numChannels, maxFrameSize);
+
+    window.assign((size_t)maxFrameSize, 0.0f);
+    searchBuffer.assign((size_t)maxFrameSize, 0.0f);
+    targetBuffer.assign((size_t)maxFrameSize, 0.0f);
+
+    // phase vocoder frame is twice the wsola frame
+    const int bins = maxFrameSize / 2 + 1;
+    fft = std::make_unique<juce::dsp::FFT>(sampleRate > 60000.0 ? 12 : 11);
+    fftBuffer.assign((size_t)maxFrameSize * 2, 0.0f);
+    magnitudes.assign((size_t)bins, 0.0f);
+    phases.assign((size_t)bins, 0.0f);
+    lastPhases.assign((size_t)numChannels, std::vector<float>((size_t)bins, 0.0f));
+    synthPhases.assign((size_t)numChannels, std::vector<float>((size_t)bins, 0.0f));
+    peaks.clear();
+    peaks.reserve((size_t)bins);
+
+    input->prepareToPlay(samplesPerBlockExpected, newSampleRate);
+
+    configure();
+    reset();
+}
+
+void TimeStretcher::releaseResources()
+{
+    input->releaseResources();
+}
+
+void TimeStretcher::setMode(Mode newMode)
+{
+    if (newMode == mode) return;
+
+    mode = newMode;
+    configure();
+    reset();
+}
+
+void TimeStretcher::setTempo(double inputPerOutput)
+{
+    tempo = juce::jlimit(minTempo, maxTempo, inputPerOutput);
+}
+
+void TimeStretcher::configure()
+{
+    // ~23ms grains at 44.1/48k, doubled at high sample rates so the sound stays the same
+    const int base = sampleRate > 60000.0 ? 2048 : 1024;
+
+    if (mode == Mode::phaseVocoder)
+    {
+        frameSize = base * 2;
+        hopSize = frameSize / 4;
+        searchRange = 0;
+        overlapLength = 0;
+
+        // hann analysis and synthesis at 75% overlap add up to 1.5
+        windowGain = 1.0f / 1.5f;
+    }
+    else
+    {
+        frameSize = base;
+        hopSize = frameSize / 2;
+        searchRange = frameSize / 4;
+        overlapLength = frameSize / 2;
+
+        // hann at 50% overlap adds up to 1
+        windowGain = 1.0f;
+    }
+
+    // periodic hann
+    for (int i = 0; i < frameSize; ++i)
+        window[(size_t)i] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (float)i / (float)frameSize);
+
+    // input is read a frame (plus the search range) ahead of the hop being played
+    latency.store(mode == Mode::off ? 0 : frameSize - hopSize + searchRange, std::memory_order_relaxed);
+}
+
+void TimeStretcher::reset()
+{
+    inputStart = 0;
+    inputLength = 0;
+    analysisPos = 0.0;
+    lastFramePos = -1;
+
+    overlapAdd.clear();
+    readyRead = 0;
+    readyLength = 0;
+
+    for (auto& p : lastPhases) std::fill(p.begin(), p.end(), 0.0f);
+    for (auto& p : synthPhases) std::fill(p.begin(), p.end(), 0.0f);
+}
+
+void TimeStretcher::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+{
+    if (mode == Mode::off)
+    {
+        input->getNextAudioBlock(info);
+        return;
+    }
+
+    auto& dest = *info.buffer;
+    const int outChannels = dest.getNumChannels();
+
+    int done = 0;
+    while (done < info.numSamples)
+    {
+        if (readyRead == readyLength)
+        {
+            runHop();
+            readyRead = 0;
+            readyLength = hopSize;
+        }
+
+        const int num = juce::jmin(readyLength - readyRead, info.numSamples - done);
+
+        for (int ch = 0; ch < outChannels; ++ch)
+            dest.copyFrom(ch, info.startSample + done, overlapAdd, juce::jmin(ch, numChannels - 1), readyRead, num);
+
+        readyRead += num;
+        done += num;
+    }
+}
+
+void TimeStretcher::runHop()
+{
+    // the hop handed out last time is done with
+    if (readyLength > 0)
+    {
+        const int keep = frameSize - hopSize;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* data = overlapAdd.getWritePointer(ch);
+            std::memmove(data, data + hopSize, (size_t)keep * sizeof(float));
+            juce::FloatVectorOperations::clear(data + keep, hopSize);
+        }
+    }
+
+    const juce::int64 nominal = (juce::int64)std::llround(analysisPos);
+    juce::int64 framePos = nominal;
+
+    if (mode == Mode::wsola)
+    {
+        if (lastFramePos >= 0)
+        {
+            // the grain that would naturally have followed the last one
+            const juce::int64 target = lastFramePos + hopSize;
+
+            pullInputUntil(juce::jmax(nominal + searchRange + frameSize, target + overlapLength));
+            framePos = findBestOffset(nominal, target);
+        }
+        else
+        {
+            pullInputUntil(nominal + frameSize);
+        }
+
+        wsolaFrame(framePos);
+    }
+    else
+    {
+        pullInputUntil(nominal + frameSize);
+
+        const int analysisHop = lastFramePos >= 0 ? juce::jmax(1, (int)(nominal - lastFramePos)) : hopSize;
+        vocoderFrame(nominal, analysisHop);
+    }
+
+    lastFramePos = framePos;
+    analysisPos += hopSize * tempo;
+
+    // the next search starts searchRange before the next nominal position
+    const juce::int64 next = (juce::int64)std::llround(analysisPos);
+    discardInputBefore(mode == Mode::wsola ? juce::jmin(next - searchRange, framePos + hopSize) : next);
+}
+
+juce::int64 TimeStretcher::findBestOffset(juce::int64 nominal, juce::int64 target)
+{
+    const juce::int64 lo = juce::jmax(inputStart, nominal - searchRange);
+    const int range = (int)(nominal + searchRange - lo);
+
+    // mono copies of the search window and of the natural continuation
+    const float* left = inputBuffer.getReadPointer(0);
+    const float* right = inputBuffer.getReadPointer(juce::jmin(1, numChannels - 1));
+
+    const int searchOffset = (int)(lo - inputStart);
+    juce::FloatVectorOperations::add(searchBuffer.data(), left + searchOffset, right + searchOffset, range + overlapLength);
+
+    const int targetOffset = (int)(target - inputStart);
+    juce::FloatVectorOperations::add(targetBuffer.data(), left + targetOffset, right + targetOffset, overlapLength);
+
+    auto correlate = [this](int offset, int step)
+    {
+        const float* a = searchBuffer.data() + offset;
+        const float* b = targetBuffer.data();
+
+        float sum = 0.0f;
+        for (int i = 0; i < overlapLength; i += step)
+            sum += a[i] * b[i];
+
+        return sum;
+    };
+
+    // coarse pass on every 4th offset and sample, then refine around the winner
+    int best = 0;
+    float bestScore = std::numeric_limits<float>::lowest();
+
+    for (int offset = 0; offset <= range; offset += 4)
+    {
+        const float score = correlate(offset, 4);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best = offset;
+        }
+    }
+
+    const int from = juce::jmax(0, best - 3);
+    const int to = juce::jmin(range, best + 3);
+    bestScore = std::numeric_limits<float>::lowest();
+
+    for (int offset = from; offset <= to; ++offset)
+    {
+        const float score = correlate(offset, 1);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best = offset;
+        }
+    }
+
+    return lo + best;
+}
+
+void TimeStretcher::wsolaFrame(juce::int64 framePos)
+{
+    const int offset = (int)(framePos - inputStart);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        juce::FloatVectorOperations::addWithMultiply(overlapAdd.getWritePointer(ch),
+                                                     inputBuffer.getReadPointer(ch, offset),
+                                                     window.data(), frameSize);
+    }
+}
+
+void TimeStretcher::vocoderFrame(juce::int64 framePos, int analysisHop)
+{
+    const int bins = frameSize / 2 + 1;
+    const int offset = (int)(framePos - inputStart);
+    const bool firstFrame = lastFramePos < 0;
+    const float binStep = juce::MathConstants<float>::twoPi / (float)frameSize;
+
+    float* buf = fftBuffer.data();
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& last = lastPhases[(size_t)ch];
+        auto& synth = synthPhases[(size_t)ch];
+
+        juce::FloatVectorOperations::multiply(buf, inputBuffer.getReadPointer(ch, offset), window.data(), frameSize);
+        juce::FloatVectorOperations::clear(buf + frameSize, frameSize);
+        fft->performRealOnlyForwardTransform(buf, true);
+
+        for (int k = 0; k < bins; ++k)
+        {
+            const float re = buf[2 * k];
+            const float im = buf[2 * k + 1];
+            magnitudes[(size_t)k] = std::sqrt(re * re + im * im);
+            phases[(size_t)k] = std::atan2(im, re);
+        }
+
+        // spectral peaks, each one owns the bins closest to it
+        peaks.clear();
+        for (int k = 2; k < bins - 2; ++k)
+        {
+            const float m = magnitudes[(size_t)k];
+            if (m > magnitudes[(size_t)k - 1] && m > magnitudes[(size_t)k - 2]
+                && m >= magnitudes[(size_t)k + 1] && m >= magnitudes[(size_t)k + 2])
+            {
+                peaks.push_back(k);
+            }
+        }
+
+        // move a bin's phase on by its measured frequency over one synthesis hop
+        auto advance = [&](int k)
+        {
+            const float omega = binStep * (float)k;
+            const float deviation = wrapPhase(phases[(size_t)k] - last[(size_t)k] - omega * (float)analysisHop);
+            synth[(size_t)k] = wrapPhase(synth[(size_t)k] + (omega + deviation / (float)analysisHop) * (float)hopSize);
+        };
+
+        if (firstFrame)
+        {
+            std::copy(phases.begin(), phases.begin() + bins, synth.begin());
+        }
+        else if (peaks.empty())
+        {
+            for (int k = 0; k < bins; ++k) advance(k);
+        }
+        else
+        {
+            for (int p : peaks) advance(p);
+
+            // identity phase locking: other bins keep their phase offset to their peak
+            size_t nearest = 0;
+            for (int k = 0; k < bins; ++k)
+            {
+                while (nearest + 1 < peaks.size() && k - peaks[nearest] > peaks[nearest + 1] - k)
+                    ++nearest;
+
+                const int p = peaks[nearest];
+                if (k != p)
+                    synth[(size_t)k] = synth[(size_t)p] + phases[(size_t)k] - phases[(size_t)p];
+            }
+        }
+
+        std::copy(phases.begin(), phases.begin() + bins, last.begin());
+
+        for (int k = 0; k < bins; ++k)
+        {
+            buf[2 * k] = magnitudes[(size_t)k] * std::cos(synth[(size_t)k]);
+            buf[2 * k + 1] = magnitudes[(size_t)k] * std::sin(synth[(size_t)k]);
+        }
+
+        fft->performRealOnlyInverseTransform(buf);
+
+        // synthesis window and overlap gain in one go
+        juce::FloatVectorOperations::multiply(buf, window.data(), frameSize);
+        juce::FloatVectorOperations::addWithMultiply(overlapAdd.getWritePointer(ch), buf, windowGain, frameSize);
+    }
+}
+
+void TimeStretcher::pullInputUntil(juce::int64 endPos)
+{
+    const int needed = (int)(endPos - (inputStart + inputLength));
+    if (needed <= 0) return;
+
+    // sized in prepareToPlay for the worst case
+    jassert(inputLength + needed <= inputBuffer.getNumSamples());
+    const int num = juce::jmin(needed, inputBuffer.getNumSamples() - inputLength);
+
+    juce::AudioSourceChannelInfo info(&inputBuffer, inputLength, num);
+    input->getNextAudioBlock(info);
+    inputLength += num;
+}
+
+void TimeStretcher::discardInputBefore(juce::int64 keepFrom)
+{
+    const int drop = (int)juce::jlimit((juce::int64)0, (juce::int64)inputLength, keepFrom - inputStart);
+    if (drop == 0) return;
+
+    const int keep = inputLength - drop;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* data = inputBuffer.getWritePointer(ch);
+        std::memmove(data, data + drop, (size_t)keep * sizeof(float));
+    }
+
+    inputLength = keep;
+    inputStart += drop;
+}
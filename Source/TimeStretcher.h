@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    TimeStretcher.h
+    Created: 17 Oct 2026 8:02:37pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// keylock: changes tempo without changing pitch
+// sits after the resampler, which then only converts the file rate, and pulls
+// tempo times as many input samples as it outputs
+// wsola: overlap-adds 50% windowed grains picked by a short correlation search (cheap)
+// phase vocoder: 75% overlap fft with identity phase locking (better on tonal material)
+// everything is allocated in prepareToPlay, each hop has a fixed cost
+class TimeStretcher : public juce::AudioSource
+{
+public:
+    enum class Mode { off = 0, wsola, phaseVocoder };
+
+    // input is not owned
+    TimeStretcher(juce::AudioSource* input, int numChannels = 2);
+    ~TimeStretcher() override = default;
+
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    // audio thread: switching mode restarts the stretcher
+    void setMode(Mode newMode);
+    Mode getMode() const { return mode; }
+
+    // audio thread: input samples per output sample
+    void setTempo(double inputPerOutput);
+
+    // any thread: how far the audible output trails the input read position,
+    // in output samples, for the current mode
+    int getLatencySamples() const { return latency.load(std::memory_order_relaxed); }
+
+    // slowest / fastest supported tempo
+    static constexpr double minTempo = 0.1;
+    static constexpr double maxTempo = 4.0;
+
+private:
+    // one frame through the current mode, leaves hopSize finished samples
+    void runHop();
+    void wsolaFrame(juce::int64 framePos);
+    void vocoderFrame(juce::int64 framePos, int analysisHop);
+
+    // best wsola grain start near nominal that continues the previous grain
+    juce::int64 findBestOffset(juce::int64 nominal, juce::int64 target);
+
+    // pull input up to (not including) absolute sample endPos
+    void pullInputUntil(juce::int64 endPos);
+
+    // forget input no later hop can reach
+    void discardInputBefore(juce::int64 keepFrom);
+
+    // frame sizes for the active mode
+    void configure();
+    void reset();
+
+    juce::AudioSource* input;
+    const int numChannels;
+
+    Mode mode{ Mode::off };
+    double tempo{ 1.0 };
+    double sampleRate{ 44100.0 };
+    int maxBlock{ 512 };
+
+    // per mode sizes
+    int frameSize{ 0 };
+    int hopSize{ 0 };
+    int searchRange{ 0 };    // wsola +-samples around the nominal position
+    int overlapLength{ 0 };  // wsola samples compared in the search
+
+    // input, inputBuffer[0] is absolute input sample inputStart
+    juce::AudioBuffer<float> inputBuffer;
+    juce::int64 inputStart{ 0 };
+    int inputLength{ 0 };
+
+    // nominal analysis position and last frame actually used
+    double analysisPos{ 0.0 };
+    juce::int64 lastFramePos{ -1 };
+
+    // overlap-add accumulator, the first hopSize samples are finished after each hop
+    juce::AudioBuffer<float> overlapAdd;
+    int readyRead{ 0 };
+    int readyLength{ 0 };
+
+    // analysis / synthesis window
+    std::vector<float> window;
+    float windowGain{ 1.0f };
+
+    // wsola correlation scratch (mono)
+    std::vector<float> searchBuffer;
+    std::vector<float> targetBuffer;
+
+    // phase vocoder state, one set per channel
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<float> fftBuffer;
+    std::vector<float> magnitudes;
+    std::vector<float> phases;
+    std::vector<std::vector<float>> lastPhases;
+    std::vector<std::vector<float>> synthPhases;
+    std::vector<int> peaks;
+
+    std::atomic<int> latency{ 0 };
+
+    // largest frame of either mode, sizes all buffers
+    static constexpr int maxFrameSize = 4096;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimeStretcher)
+};
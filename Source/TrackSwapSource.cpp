@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    TrackSwapSource.cpp
+    Created: 17 Oct 2026 2:05:11pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TrackSwapSource.h"
+
+TrackSwapSource::~TrackSwapSource()
+{
+    // audio is stopped by now, safe to free everything here
+    delete pending.exchange(nullptr);
+    delete retired.exchange(nullptr);
+    delete current;
+}
+
+void TrackSwapSource::prepareToPlay(int, double)
+{
+}
+
+void TrackSwapSource::releaseResources()
+{
+}
+
+void TrackSwapSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+{
+    // swap in a new track only once the previous old one has been collected
+    if (retired.load(std::memory_order_acquire) == nullptr)
+    {
+        if (auto* next = pending.exchange(nullptr, std::memory_order_acq_rel))
+        {
+            retired.store(current, std::memory_order_release);
+            current = next;
+
+            position.store(current->source->getNextReadPosition(), std::memory_order_release);
+            length.store(current->source->getTotalLength(), std::memory_order_release);
+            sourceRate.store(current->sampleRate, std::memory_order_release);
+            playing.store(current->startPlaying, std::memory_order_release);
+        }
+    }
+
+    if (current == nullptr)
+    {
+        info.clearActiveBufferRegion();
+        return;
+    }
+
+    auto& source = *current->source;
+
+    // apply seeks from the message thread
+    const auto seek = pendingSeek.exchange(-1, std::memory_order_acq_rel);
+    if (seek >= 0)
+    {
+        source.setNextReadPosition(seek);
+        position.store(seek, std::memory_order_release);
+    }
+
+    if (!playing.load(std::memory_order_acquire))
+    {
+        info.clearActiveBufferRegion();
+        bufferHealth.store(source.getBufferHealth(), std::memory_order_relaxed);
+        return;
+    }
+
+    source.getNextAudioBlock(info);
+
+    const auto pos = source.getNextReadPosition();
+    position.store(pos, std::memory_order_release);
+    bufferHealth.store(source.getBufferHealth(), std::memory_order_relaxed);
+    underrunCount.store(source.getUnderrunCount(), std::memory_order_relaxed);
+
+    // stop at the end of the track like the transport used to
+    if (pos >= source.getTotalLength())
+        playing.store(false, std::memory_order_release);
+}
+
+void TrackSwapSource::publish(std::unique_ptr<LoadedTrack> track)
+{
+    // an older load that never reached the audio thread is dropped here
+    delete pending.exchange(track.release(), std::memory_order_acq_rel);
+}
+
+void TrackSwapSource::collectGarbage()
+{
+    delete retired.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+void TrackSwapSource::setPosition(juce::int64 samplePos)
+{
+    pendingSeek.store(juce::jmax((juce::int64)0, samplePos), std::memory_order_release);
+}
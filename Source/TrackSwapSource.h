@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    TrackSwapSource.h
+    Created: 17 Oct 2026 2:05:11pm
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DeckStream.h"
+
+// holds the deck's current track and play state
+// new tracks are handed over through an atomic pointer, the audio thread picks
+// them up at the start of a block, and the old one is parked for the message or
+// loader thread to delete, so the audio thread never locks or frees anything
+class TrackSwapSource : public juce::AudioSource
+{
+public:
+    // a fully opened and primed track, built off the audio thread
+    struct LoadedTrack
+    {
+        std::unique_ptr<DeckStream> source;
+        juce::URL url;
+        double sampleRate{ 0.0 };
+        bool startPlaying{ false };
+    };
+
+    TrackSwapSource() = default;
+    ~TrackSwapSource() override;
+
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    // any thread but audio: queue a track, replaces one that has not been picked up yet
+    void publish(std::unique_ptr<LoadedTrack> track);
+
+    // any thread but audio: delete the track the audio thread swapped out
+    void collectGarbage();
+
+    // true until the audio thread has picked up the last published track
+    bool isPending() const { return pending.load(std::memory_order_acquire) != nullptr; }
+
+    // playback control, applied on the next block
+    void start() { playing.store(true, std::memory_order_release); }
+    void stop() { playing.store(false, std::memory_order_release); }
+    bool isPlaying() const { return playing.load(std::memory_order_acquire); }
+
+    // in file samples, applied by the audio thread on the next block
+    void setPosition(juce::int64 samplePos);
+
+    // state published by the audio thread
+    juce::int64 getPosition() const { return position.load(std::memory_order_acquire); }
+    juce::int64 getLength() const { return length.load(std::memory_order_acquire); }
+    double getSourceSampleRate() const { return sourceRate.load(std::memory_order_acquire); }
+    float getBufferHealth() const { return bufferHealth.load(std::memory_order_relaxed); }
+    int getUnderrunCount() const { return underrunCount.load(std::memory_order_relaxed); }
+
+private:
+    // owned by the audio thread
+    LoadedTrack* current{ nullptr };
+
+    // hand-over slots
+    std::atomic<LoadedTrack*> pending{ nullptr };
+    std::atomic<LoadedTrack*> retired{ nullptr };
+
+    std::atomic<bool> playing{ false };
+    std::atomic<juce::int64> pendingSeek{ -1 };
+
+    std::atomic<juce::int64> position{ 0 };
+    std::atomic<juce::int64> length{ 0 };
+    std::atomic<double> sourceRate{ 0.0 };
+    std::atomic<float> bufferHealth{ 1.0f };
+    std::atomic<int> underrunCount{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackSwapSource)
+};
@@ -15,89 +15,116 @@
 // draws and rotates a pixel art record image when the player is playing
 VinylSpinner::VinylSpinner(DJAudioPlayer* p, double rpmIn) : player(p), rpm(rpmIn)
 {
-    startTimer(30); // for 30fps
     setInterceptsMouseClicks(false, false);
 }
 
 VinylSpinner::~VinylSpinner()
 {
-    // stop timer when destroyed
-    stopTimer();
 }
 
 void VinylSpinner::paint(juce::Graphics& g)
 {
     g.fillAll(juce::Colours::transparentBlack); // clear with transparent bg
-    if (!vinyl.isValid()) return; // don't draw if image not set
 
-    const int compW = getWidth();
-    const int compH = getHeight();
+    // moved to a display with another scale
+    const float scale = (float)g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (scale != atlasScale)
+        rebuildAtlas(scale);
+
+    if (!atlas.isValid()) return; // don't draw if image not set
+
+    // center on whole physical pixels (avoid half-pixel blur)
+    const float x = std::floor((getWidth() * scale - frameSize) * 0.5f) / scale;
+    const float y = std::floor((getHeight() * scale - frameSize) * 0.5f) / scale;
+    const float size = frameSize / scale;
+
+    // one cell, one atlas pixel per screen pixel
+    // nearest-neighbor for pixel art (no blur)
+    g.setImageResamplingQuality(juce::Graphics::lowResamplingQuality);
+    g.drawImage(frames[(size_t)currentFrame], { x, y, size, size });
+}
+
+void VinylSpinner::rebuildAtlas(float scale)
+{
+    atlas = {};
+    frames.fill({});
+    atlasScale = scale;
+    if (!vinyl.isValid() || getWidth() <= 0 || getHeight() <= 0) return;
+
     const int imgW = vinyl.getWidth();
     const int imgH = vinyl.getHeight();
 
-    // target square size
-    const int target = std::min(compW, compH);
+    // target square size, in physical pixels
+    const int target = (int)(std::min(getWidth(), getHeight()) * scale);
 
     // nearest integer scaling for pixel rendering
-    int integerScale = std::max(1, target / std::max(imgW, imgH));  
-    int drawW = imgW * integerScale;
-    int drawH = imgH * integerScale;
-
-    // center on whole pixels (avoid half-pixel blur)
-    const int cx = compW / 2;
-    const int cy = compH / 2;
-
-    // build transform:
-    // move image center to origin
-    // scale by integer factor (no interpolation)
-    // rotate around origin
-    // translate to component center (integer coords)
-    juce::AffineTransform t =
-        juce::AffineTransform::translation(-imgW * 0.5f, -imgH * 0.5f)
-        .scaled((float)integerScale, (float)integerScale)
-        .rotated((float)currentAngle)
-        .translated((float)cx, (float)cy);
+    const int integerScale = std::max(1, target / std::max(imgW, imgH));
 
-    // nearest-neighbor for pixel art (no blur)
-    g.setImageResamplingQuality(juce::Graphics::lowResamplingQuality);
+    // the record is round, it stays inside its own square at any angle
+    frameSize = std::max(imgW, imgH) * integerScale;
 
-    // false avoids extra filtering passes
-    g.drawImageTransformed(vinyl, t, false);
-}
+    const int rows = (numFrames + framesPerRow - 1) / framesPerRow;
+    atlas = juce::Image(juce::Image::ARGB, frameSize * framesPerRow, frameSize * rows, true);
 
+    juce::Graphics g(atlas);
 
+    // nearest-neighbor for pixel art (no blur)
+    g.setImageResamplingQuality(juce::Graphics::lowResamplingQuality);
 
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        const int cellX = (frame % framesPerRow) * frameSize;
+        const int cellY = (frame / framesPerRow) * frameSize;
+
+        // build transform:
+        // move image center to origin
+        // scale by integer factor (no interpolation)
+        // rotate around origin
+        // translate to the cell center (integer coords)
+        const juce::AffineTransform t =
+            juce::AffineTransform::translation(-imgW * 0.5f, -imgH * 0.5f)
+            .scaled((float)integerScale, (float)integerScale)
+            .rotated(juce::MathConstants<float>::twoPi * (float)frame / (float)numFrames)
+            .translated((float)(cellX + frameSize / 2), (float)(cellY + frameSize / 2));
+
+        // corners of a neighbour mustn't spill into this cell
+        juce::Graphics::ScopedSaveState save(g);
+        g.reduceClipRegion(cellX, cellY, frameSize, frameSize);
+
+        // false avoids extra filtering passes
+        g.drawImageTransformed(vinyl, t, false);
+
+        frames[(size_t)frame] = atlas.getClippedImage({ cellX, cellY, frameSize, frameSize });
+    }
+}
 
 void VinylSpinner::resized()
 {
-    // This method is where you should set the bounds of any child
-    // components that your component contains..
-
+    // the scale depends on the size
+    rebuildAtlas(juce::Component::getApproximateScaleFactorForComponent(this));
 }
 
 // stores new image and redraws with new vinyl
 void VinylSpinner::setImage(const juce::Image& img)
 {
     vinyl = img;
+    rebuildAtlas(juce::Component::getApproximateScaleFactorForComponent(this));
     repaint();
 }
 
-void VinylSpinner::timerCallback()
+void VinylSpinner::advance()
 {
-    // only rotate when audio is playing
-    if (player != nullptr && player->isPlaying())
-    {
-        const double fps = 30.0;
-        // angle by rpm converted to radians
-        currentAngle += juce::MathConstants<double>::twoPi * (rpm / 60.0) * (1.0 / fps);
+    if (player == nullptr) return;
 
-        // constrain to 0-2pi
-        if (currentAngle > juce::MathConstants<double>::twoPi)
-        {
-            currentAngle -= juce::MathConstants<double>::twoPi;
-        }
+    // turns of the record since the start of the track, so seeking, pitch and stops all
+    // show as they are heard
+    const double turns = player->getPlayhead().getSecondsNow() * rpm / 60.0;
+    const int frame = (int)std::fmod(std::round(turns * numFrames), (double)numFrames);
 
-        // redraw
+    // only redraw when it lands on another step
+    if (frame != currentFrame)
+    {
+        currentFrame = frame;
         repaint();
     }
 }
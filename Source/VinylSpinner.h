@@ -13,8 +13,7 @@
 #include <JuceHeader.h>
 class DJAudioPlayer;
 
-class VinylSpinner  : public juce::Component,
-                      private juce::Timer
+class VinylSpinner  : public juce::Component
 {
 public:
     VinylSpinner(DJAudioPlayer* p, double rpm = 33.333);
@@ -26,14 +25,32 @@ public:
     // sets vinyl image
     void setImage(const juce::Image& img);
 
+    // rotation steps pre-rendered, 5.6 degrees apart
+    static constexpr int numFrames = 64;
+
 private:
-    void timerCallback() override;
+    // every frame: pick the rotation for where the deck is in its track
+    void advance();
+
+    // draws every rotation at the current integer scale, in physical pixels
+    // on resize, setImage and when the display scale changes
+    void rebuildAtlas(float scale);
 
     // player ref
     DJAudioPlayer* player = nullptr;
     juce::Image vinyl;
     double rpm = 33.333;
-    double currentAngle = 0.0;
+
+    // numFrames square cells, framesPerRow across, frames[i] is cell i
+    static constexpr int framesPerRow = 8;
+    juce::Image atlas;
+    std::array<juce::Image, numFrames> frames;
+    float atlasScale = 0.0f;
+    int frameSize = 0; // physical pixels
+    int currentFrame = 0;
+
+    // declared last, it calls advance
+    juce::VBlankAttachment vblank{ this, [this] { advance(); } };
 
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VinylSpinner)
@@ -12,14 +12,13 @@
 #include "WaveformDisplay.h"
 #include "Theme.h"
 
-WaveformDisplay::WaveformDisplay(juce::AudioFormatManager& formatManagerToUse,
-                                 juce::AudioThumbnailCache& cacheToUse)
-                                 : audioThumb(1000, formatManagerToUse, cacheToUse),
+WaveformDisplay::WaveformDisplay(WaveformCache& cacheToUse)
+                                 : cache(cacheToUse),
                                    fileLoaded(false),
                                    position(0)
 {
-    audioThumb.addChangeListener(this);
-
+    // the cached image covers every pixel, nothing behind needs repainting
+    setOpaque(true);
 }
 
 WaveformDisplay::~WaveformDisplay()
@@ -28,6 +27,37 @@ WaveformDisplay::~WaveformDisplay()
 
 void WaveformDisplay::paint (juce::Graphics& g)
 {
+    // https://docs.juce.com/master/classImage.html <-- documentation used
+    // physical pixels, so the cache stays sharp on hi-dpi screens
+    const float scale = (float)g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (waveDirty || scale != waveScale)
+        renderWave(scale);
+
+    // only the clipped (dirty) part is actually copied
+    g.drawImage(waveImage, getLocalBounds().toFloat());
+
+    if (fileLoaded) 
+    {
+        g.setColour(Theme::accent);
+        g.drawRect(getPlayheadBounds(position));
+    }
+}
+
+void WaveformDisplay::renderWave(float scale)
+{
+    waveDirty = false;
+    waveScale = scale;
+
+    const int w = juce::jmax(1, juce::roundToInt(getWidth() * scale));
+    const int h = juce::jmax(1, juce::roundToInt(getHeight() * scale));
+
+    if (waveImage.getWidth() != w || waveImage.getHeight() != h)
+        waveImage = juce::Image(juce::Image::ARGB, w, h, true);
+
+    juce::Graphics g(waveImage);
+    g.addTransform(juce::AffineTransform::scale(scale));
+
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));   // clear the background
 
     g.setColour (Theme::panelBg);
@@ -37,44 +67,121 @@ void WaveformDisplay::paint (juce::Graphics& g)
 
     if (fileLoaded) 
     {
-        audioThumb.drawChannel(g, getLocalBounds(), 0, audioThumb.getTotalLength(), 0, 1.0);
-        g.setColour(Theme::accent);
-        g.drawRect(position * getWidth(), 0, getWidth() / 20, getHeight());
+        // one column per physical pixel, min to max, rms on top, coloured by its bands
+        const float midY = getHeight() * 0.5f;
+        const float halfH = getHeight() * 0.5f;
+        const float colW = 1.0f / scale;
+        const juce::int64 total = pyramid->getLengthInSamples();
+
+        for (int px = 0; px < w; ++px)
+        {
+            const auto range = pyramid->getRange(total * px / w, total * (px + 1) / w);
+            const float x = px * colW;
+
+            const auto colour = getBandColour(range);
+
+            g.setColour(colour.withMultipliedAlpha(0.6f));
+            g.fillRect(x, midY - range.max * halfH, colW, juce::jmax(colW, (range.max - range.min) * halfH));
+
+            g.setColour(colour);
+            g.fillRect(x, midY - range.rms * halfH, colW, range.rms * 2.0f * halfH);
+        }
     }
     else 
     {
         g.setFont(juce::FontOptions(20.0f));
-        g.drawText("File not loaded...", getLocalBounds(),
+        g.drawText(analysing ? "Analysing..." : "File not loaded...", getLocalBounds(),
             juce::Justification::centred, true);   // draw some placeholder text
     }
+}
+
+juce::Colour WaveformDisplay::getBandColour(const WaveformPyramid::Range& range)
+{
+    // highs carry far less energy than bass, weighted up so hats and vocals still show
+    const float low = range.low;
+    const float mid = range.mid * 2.0f;
+    const float high = range.high * 4.0f;
+    const float total = low + mid + high;
+
+    if (total <= 0.0f) return Theme::trackBase;
+
+    auto mix = [&](auto channel)
+        {
+            return (channel(Theme::waveLow) * low + channel(Theme::waveMid) * mid + channel(Theme::waveHigh) * high) / total;
+        };
+
+    return juce::Colour::fromFloatRGBA(mix([](juce::Colour c) { return c.getFloatRed(); }),
+                                       mix([](juce::Colour c) { return c.getFloatGreen(); }),
+                                       mix([](juce::Colour c) { return c.getFloatBlue(); }), 1.0f);
+}
 
+void WaveformDisplay::invalidateWave()
+{
+    waveDirty = true;
+    repaint();
+}
 
+juce::Rectangle<int> WaveformDisplay::getPlayheadBounds(double pos) const
+{
+    return { juce::roundToInt(pos * getWidth()), 0, juce::jmax(1, getWidth() / 20), getHeight() };
 }
 
 void WaveformDisplay::resized()
 {
-
+    invalidateWave();
 }
 
-void WaveformDisplay::changeListenerCallback(juce::ChangeBroadcaster* source)
+void WaveformDisplay::lookAndFeelChanged()
 {
-    repaint();
+    invalidateWave();
 }
 
+
 void WaveformDisplay::loadURL(juce::URL audioURL)
 {
-    // clear thumbnail
-    audioThumb.clear();
-    // unpack url into inputSource and set the thumbnail to that
-    fileLoaded = audioThumb.setSource(new juce::URLInputSource(audioURL));
+    // clear the old waveform
+    pyramid.reset();
+    fileLoaded = false;
+    analysing = audioURL.isLocalFile();
+
+    // a later load replaces this one
+    const int id = ++loadId;
 
+    if (onPyramidChanged)
+        onPyramidChanged(nullptr);
+
+    if (analysing)
+    {
+        cache.request(audioURL.getLocalFile(),
+            [safeThis = juce::Component::SafePointer<WaveformDisplay>(this), id](std::shared_ptr<const WaveformPyramid> result)
+            {
+                if (safeThis == nullptr || safeThis->loadId != id) return;
+
+                safeThis->pyramid = std::move(result);
+                safeThis->fileLoaded = safeThis->pyramid != nullptr;
+                safeThis->analysing = false;
+                safeThis->invalidateWave();
+
+                if (safeThis->onPyramidChanged)
+                    safeThis->onPyramidChanged(safeThis->pyramid);
+            });
+    }
+
+    invalidateWave();
 }
 
 void WaveformDisplay::setPositionRelative(double pos)
 {
     if (pos != position)
     {
+        const auto oldBounds = getPlayheadBounds(position);
         position = pos;
-        repaint();
+        const auto newBounds = getPlayheadBounds(position);
+
+        // same pixels, nothing to redraw
+        if (!fileLoaded || oldBounds == newBounds) return;
+
+        repaint(oldBounds);
+        repaint(newBounds);
     }
 }
@@ -1,29 +1,51 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "WaveformPyramid.h"
 
-class WaveformDisplay  : public juce::Component, public juce::ChangeListener
+class WaveformDisplay  : public juce::Component
 {
 public:
-    WaveformDisplay(juce::AudioFormatManager& formatManagerToUse,
-                    juce::AudioThumbnailCache& cacheToUse
-    );
+    WaveformDisplay(WaveformCache& cacheToUse);
     ~WaveformDisplay() override;
 
     void paint (juce::Graphics&) override;
     void resized() override;
+    void lookAndFeelChanged() override;
 
-    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
-
+    // the waveform shows once the cache has it, straight away for tracks seen before
     void loadURL(juce::URL audioURL);
 
     // set position of playhead
     void setPositionRelative(double pos);
 
+    // the loaded track's pyramid arrived (or was cleared by a new load), to share with other views
+    std::function<void(std::shared_ptr<const WaveformPyramid>)> onPyramidChanged;
+
+    // blend of the low / mid / high colours by band energy
+    static juce::Colour getBandColour(const WaveformPyramid::Range& range);
+
 private:
-    juce::AudioThumbnail audioThumb;
+    WaveformCache& cache;
+    std::shared_ptr<const WaveformPyramid> pyramid;
     bool fileLoaded;
     double position;
 
+    // waiting on the cache, and which load it is for
+    bool analysing{ false };
+    int loadId{ 0 };
+
+    // the waveform drawn once, rebuilt on resize, load or when the pyramid arrives
+    // moving the playhead only repaints where it was and where it is now
+    juce::Image waveImage;
+    float waveScale{ 0.0f };
+    bool waveDirty{ true };
+
+    void invalidateWave();
+    void renderWave(float scale);
+
+    // area the playhead covers at pos
+    juce::Rectangle<int> getPlayheadBounds(double pos) const;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformDisplay)
 };
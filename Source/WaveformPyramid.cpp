@@ -0,0 +1,537 @@
+/*
+  ==============================================================================
+
+    WaveformPyramid.cpp
+    Created: 18 Oct 2026 4:12:37am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "WaveformPyramid.h"
+
+namespace
+{
+    using Bin = WaveformPyramid::Bin;
+    static_assert(sizeof(Bin) == 6, "bins are written to disk as is");
+
+    // sidecar layout, little endian:
+    // magic, version, sample rate, length, level count, base samples per bin,
+    // bin count of every level, then every level's bins, finest first
+    constexpr int magic = 0x50574650;   // "PFWP"
+    constexpr int version = 2;
+    constexpr size_t fixedHeaderBytes = 4 + 4 + 8 + 8 + 4 + 4;
+    constexpr int maxLevels = 40;
+
+    // bins decoded per read
+    constexpr int binsPerBlock = 4096;
+
+    // decoded ahead of a slice so its filters have settled by the first bin
+    constexpr int preRollSamples = 8192;
+
+    juce::int64 binsAbove(juce::int64 numBins) { return (numBins + 1) / 2; }
+
+    juce::uint8 toLevel(float v) { return (juce::uint8)juce::roundToInt(juce::jlimit(0.0f, 1.0f, v) * 255.0f); }
+    juce::int8 toPeak(float v) { return (juce::int8)juce::roundToInt(juce::jlimit(-1.0f, 1.0f, v) * 127.0f); }
+
+    juce::uint8 combineLevel(juce::uint8 a, juce::uint8 b)
+    {
+        return (juce::uint8)juce::roundToInt(std::sqrt(((float)a * a + (float)b * b) * 0.5f));
+    }
+
+    // one bin of the level above
+    Bin combine(const Bin& a, const Bin& b)
+    {
+        return { juce::jmin(a.min, b.min), juce::jmax(a.max, b.max), combineLevel(a.rms, b.rms),
+                 combineLevel(a.low, b.low), combineLevel(a.mid, b.mid), combineLevel(a.high, b.high) };
+    }
+
+    float sumOfSquares(const float* data, int num)
+    {
+        float total = 0.0f;
+        for (int i = 0; i < num; ++i)
+            total += data[i] * data[i];
+
+        return total;
+    }
+
+    // https://docs.juce.com/master/structdsp_1_1SIMDRegister.html <-- documentation used
+    // low / mid / high crossover as lanes 0, 1, 2 of one biquad cascade, so one pass of
+    // vector maths filters all three bands of a sample
+    // low:  LP, LP, -, -     mid: HP, HP, LP, LP     high: HP, HP, -, -   (- passes through)
+    class BandSplitter
+    {
+    public:
+        static constexpr int numBands = 3;
+
+        explicit BandSplitter(double sampleRate)
+        {
+            using Coefs = juce::dsp::IIR::Coefficients<float>;
+
+            // butterworth pairs make 4th order linkwitz-riley
+            const auto lowLP = Coefs::makeLowPass(sampleRate, WaveformPyramid::lowCrossover);
+            const auto lowHP = Coefs::makeHighPass(sampleRate, WaveformPyramid::lowCrossover);
+            const auto highLP = Coefs::makeLowPass(sampleRate, WaveformPyramid::highCrossover);
+            const auto highHP = Coefs::makeHighPass(sampleRate, WaveformPyramid::highCrossover);
+
+            const Coefs* plan[numStages][numBands] = { { lowLP.get(), lowHP.get(), highHP.get() },
+                                                       { lowLP.get(), lowHP.get(), highHP.get() },
+                                                       { nullptr,     highLP.get(), nullptr },
+                                                       { nullptr,     highLP.get(), nullptr } };
+
+            for (int s = 0; s < numStages; ++s)
+                for (int band = 0; band < numBands; ++band)
+                {
+                    // b0 b1 b2 a1 a2, a0 normalised out
+                    const float pass[5] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+                    const float* c = plan[s][band] != nullptr ? plan[s][band]->getRawCoefficients() : pass;
+
+                    for (int k = 0; k < 5; ++k)
+                        setLane(stages[s].coefs[k], band, c[k]);
+                }
+        }
+
+       #if JUCE_USE_SIMD
+        using Lanes = juce::dsp::SIMDRegister<float>;
+        static_assert(Lanes::SIMDNumElements >= numBands, "one lane per band");
+
+        static Lanes expand(float v) { return Lanes::expand(v); }
+        static void setLane(Lanes& r, int lane, float v) { r.set((size_t)lane, v); }
+        static float getLane(const Lanes& r, int lane) { return r.get((size_t)lane); }
+       #else
+        // same maths a lane at a time
+        struct Lanes
+        {
+            float v[numBands]{};
+
+            Lanes operator+(const Lanes& o) const { Lanes r; for (int i = 0; i < numBands; ++i) r.v[i] = v[i] + o.v[i]; return r; }
+            Lanes operator-(const Lanes& o) const { Lanes r; for (int i = 0; i < numBands; ++i) r.v[i] = v[i] - o.v[i]; return r; }
+            Lanes operator*(const Lanes& o) const { Lanes r; for (int i = 0; i < numBands; ++i) r.v[i] = v[i] * o.v[i]; return r; }
+            Lanes& operator+=(const Lanes& o) { return *this = *this + o; }
+        };
+
+        static Lanes expand(float x) { Lanes r; for (auto& v : r.v) v = x; return r; }
+        static void setLane(Lanes& r, int lane, float v) { r.v[lane] = v; }
+        static float getLane(const Lanes& r, int lane) { return r.v[lane]; }
+       #endif
+
+        // every band of one input sample, transposed direct form II
+        Lanes process(float x)
+        {
+            Lanes v = expand(x);
+
+            for (auto& st : stages)
+            {
+                const Lanes y = st.coefs[0] * v + st.s1;
+                st.s1 = st.coefs[1] * v - st.coefs[3] * y + st.s2;
+                st.s2 = st.coefs[2] * v - st.coefs[4] * y;
+                v = y;
+            }
+
+            return v;
+        }
+
+    private:
+        static constexpr int numStages = 4;
+
+        struct Stage
+        {
+            Lanes coefs[5]{};
+            Lanes s1{}, s2{};
+        };
+
+        Stage stages[numStages];
+    };
+
+    // level 0 bins [firstBin, endBin) of the track, on its own reader
+    bool analyseRange(juce::AudioFormatManager& formatManager, const juce::File& track, juce::int64 length,
+                      Bin* bins, juce::int64 firstBin, juce::int64 endBin, const std::atomic<bool>& cancelled)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(track));
+        if (reader == nullptr) return false;
+
+        constexpr int base = WaveformPyramid::baseSamplesPerBin;
+        juce::AudioBuffer<float> buffer(2, juce::jmax(binsPerBlock * base, preRollSamples));
+
+        BandSplitter splitter(reader->sampleRate);
+
+        // mono files come back on both channels
+        auto mono = [&](int i) { return 0.5f * (buffer.getSample(0, i) + buffer.getSample(1, i)); };
+
+        // settle the filters on the audio before the slice
+        {
+            const juce::int64 start = firstBin * base;
+            const int preRoll = (int)juce::jmin((juce::int64)preRollSamples, start);
+
+            if (preRoll > 0 && reader->read(&buffer, 0, preRoll, start - preRoll, true, true))
+                for (int i = 0; i < preRoll; ++i)
+                    splitter.process(mono(i));
+        }
+
+        for (juce::int64 b = firstBin; b < endBin; b += binsPerBlock)
+        {
+            if (cancelled.load(std::memory_order_relaxed)) return false;
+
+            const int numBins = (int)juce::jmin((juce::int64)binsPerBlock, endBin - b);
+            const juce::int64 start = b * base;
+            const int numSamples = (int)juce::jmin((juce::int64)numBins * base, length - start);
+
+            if (!reader->read(&buffer, 0, numSamples, start, true, true)) return false;
+
+            for (int i = 0; i < numBins; ++i)
+            {
+                const int offset = i * base;
+                const int n = juce::jmin(base, numSamples - offset);
+
+                float lo = 1.0f, hi = -1.0f, squares = 0.0f;
+                for (int c = 0; c < 2; ++c)
+                {
+                    const float* src = buffer.getReadPointer(c, offset);
+                    const auto range = juce::FloatVectorOperations::findMinAndMax(src, n);
+                    lo = juce::jmin(lo, range.getStart());
+                    hi = juce::jmax(hi, range.getEnd());
+                    squares += sumOfSquares(src, n);
+                }
+
+                // band energies of the mono mix
+                auto bandSquares = BandSplitter::expand(0.0f);
+                for (int s = offset; s < offset + n; ++s)
+                {
+                    const auto y = splitter.process(mono(s));
+                    bandSquares += y * y;
+                }
+
+                const float scale = 1.0f / (float)n;
+                bins[b + i] = { toPeak(lo), toPeak(hi), toLevel(std::sqrt(squares / (float)(2 * n))),
+                                toLevel(std::sqrt(BandSplitter::getLane(bandSquares, 0) * scale)),
+                                toLevel(std::sqrt(BandSplitter::getLane(bandSquares, 1) * scale)),
+                                toLevel(std::sqrt(BandSplitter::getLane(bandSquares, 2) * scale)) };
+            }
+        }
+
+        return true;
+    }
+
+    // size, modification time and a hash of the first and last 64 KB,
+    // tells tracks apart without reading all of them; empty if it can't be read
+    juce::String getQuickKey(const juce::File& track)
+    {
+        constexpr int edgeBytes = 64 * 1024;
+
+        juce::FileInputStream in(track);
+        if (!in.openedOk()) return {};
+
+        const auto size = in.getTotalLength();
+        juce::MemoryBlock edges;
+        in.readIntoMemoryBlock(edges, edgeBytes);
+
+        if (size > edgeBytes)
+        {
+            in.setPosition(juce::jmax((juce::int64)edgeBytes, size - edgeBytes));
+            in.readIntoMemoryBlock(edges, edgeBytes);
+        }
+
+        return juce::String::toHexString(size) + "_"
+             + juce::String::toHexString(track.getLastModificationTime().toMilliseconds()) + "_"
+             + juce::MD5(edges).toHexString().substring(0, 16);
+    }
+}
+
+//==============================================================================
+std::unique_ptr<WaveformPyramid> WaveformPyramid::open(const juce::File& sidecar)
+{
+    if (!sidecar.existsAsFile()) return nullptr;
+
+    std::unique_ptr<WaveformPyramid> pyramid(new WaveformPyramid());
+    pyramid->mapped = std::make_unique<juce::MemoryMappedFile>(sidecar, juce::MemoryMappedFile::readOnly);
+    pyramid->data = static_cast<const char*>(pyramid->mapped->getData());
+    pyramid->size = pyramid->mapped->getSize();
+
+    if (pyramid->data == nullptr || !pyramid->parse()) return nullptr;
+
+    return pyramid;
+}
+
+std::unique_ptr<WaveformPyramid> WaveformPyramid::build(juce::AudioFormatManager& formatManager,
+                                                        const juce::File& track,
+                                                        const juce::File& sidecar,
+                                                        juce::ThreadPool& pool,
+                                                        const std::atomic<bool>& cancelled)
+{
+    double rate = 0.0;
+    juce::int64 length = 0;
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(track));
+        if (reader == nullptr) return nullptr;
+
+        rate = reader->sampleRate;
+        length = reader->lengthInSamples;
+    }
+
+    if (length <= 0 || rate <= 0.0) return nullptr;
+
+    // every level, finest first
+    std::vector<std::vector<Bin>> built;
+    built.emplace_back((size_t)((length + baseSamplesPerBin - 1) / baseSamplesPerBin));
+
+    // level 0 in contiguous slices, one reader per worker
+    {
+        const juce::int64 numBins = (juce::int64)built[0].size();
+        const int numJobs = (int)juce::jlimit((juce::int64)1, (juce::int64)pool.getNumThreads(),
+                                              (numBins + binsPerBlock - 1) / binsPerBlock);
+
+        std::atomic<int> remaining{ numJobs };
+        std::atomic<bool> failed{ false };
+        juce::WaitableEvent finished;
+
+        for (int j = 0; j < numJobs; ++j)
+        {
+            const juce::int64 first = numBins * j / numJobs;
+            const juce::int64 end = numBins * (j + 1) / numJobs;
+
+            pool.addJob([&, first, end]
+                {
+                    if (!analyseRange(formatManager, track, length, built[0].data(), first, end, cancelled))
+                        failed.store(true);
+
+                    if (--remaining == 0)
+                        finished.signal();
+                });
+        }
+
+        finished.wait();
+
+        if (failed.load() || cancelled.load()) return nullptr;
+    }
+
+    // the rest from the level below
+    while ((juce::int64)built.back().size() > maxTopBins && (int)built.size() < maxLevels)
+    {
+        const auto& below = built.back();
+        std::vector<Bin> above((size_t)binsAbove((juce::int64)below.size()));
+
+        for (size_t i = 0; i < above.size(); ++i)
+            above[i] = 2 * i + 1 < below.size() ? combine(below[2 * i], below[2 * i + 1]) : below[2 * i];
+
+        built.push_back(std::move(above));
+    }
+
+    // the file image, used straight away and saved for next time
+    std::unique_ptr<WaveformPyramid> pyramid(new WaveformPyramid());
+    {
+        juce::MemoryOutputStream out(pyramid->owned, false);
+        out.writeInt(magic);
+        out.writeInt(version);
+        out.writeDouble(rate);
+        out.writeInt64(length);
+        out.writeInt((int)built.size());
+        out.writeInt(baseSamplesPerBin);
+
+        for (const auto& level : built)
+            out.writeInt64((juce::int64)level.size());
+
+        for (const auto& level : built)
+            out.write(level.data(), level.size() * sizeof(Bin));
+    }
+
+    pyramid->data = static_cast<const char*>(pyramid->owned.getData());
+    pyramid->size = pyramid->owned.getSize();
+
+    if (!pyramid->parse()) return nullptr;
+
+    // written aside and swapped in, so a half written sidecar is never mapped
+    if (sidecar.getParentDirectory().createDirectory())
+    {
+        juce::TemporaryFile temp(sidecar);
+
+        if (temp.getFile().replaceWithData(pyramid->owned.getData(), pyramid->owned.getSize()))
+            temp.overwriteTargetFileWithTemporary();
+    }
+
+    return pyramid;
+}
+
+bool WaveformPyramid::parse()
+{
+    if (size < fixedHeaderBytes) return false;
+
+    juce::MemoryInputStream in(data, size, false);
+
+    if (in.readInt() != magic || in.readInt() != version) return false;
+
+    sampleRate = in.readDouble();
+    length = in.readInt64();
+    const int numLevels = in.readInt();
+    const int base = in.readInt();
+
+    if (sampleRate <= 0.0 || length <= 0 || base != baseSamplesPerBin
+        || numLevels <= 0 || numLevels > maxLevels)
+        return false;
+
+    size_t offset = fixedHeaderBytes + (size_t)numLevels * 8;
+    juce::int64 expected = (length + base - 1) / base;
+
+    levels.clear();
+
+    for (int l = 0; l < numLevels; ++l)
+    {
+        const juce::int64 numBins = in.readInt64();
+        if (numBins != expected || offset + (size_t)numBins * sizeof(Bin) > size) return false;
+
+        levels.push_back({ reinterpret_cast<const Bin*>(data + offset), numBins });
+        offset += (size_t)numBins * sizeof(Bin);
+        expected = binsAbove(expected);
+    }
+
+    return offset == size;
+}
+
+WaveformPyramid::Range WaveformPyramid::getRange(juce::int64 startSample, juce::int64 endSample) const
+{
+    startSample = juce::jmax((juce::int64)0, startSample);
+    endSample = juce::jmin(length, endSample);
+    if (levels.empty() || endSample <= startSample) return {};
+
+    // coarsest level whose bins are no wider than the range
+    const juce::int64 span = endSample - startSample;
+    int level = 0;
+    while (level + 1 < getNumLevels() && (juce::int64)getSamplesPerBin(level + 1) <= span)
+        ++level;
+
+    const juce::int64 perBin = getSamplesPerBin(level);
+    const juce::int64 first = startSample / perBin;
+    const juce::int64 last = juce::jmin(getNumBins(level) - 1, (endSample - 1) / perBin);
+
+    const Bin* bins = getBins(level);
+    int lo = 127, hi = -127;
+    float squares = 0.0f, lowSquares = 0.0f, midSquares = 0.0f, highSquares = 0.0f;
+
+    for (juce::int64 b = first; b <= last; ++b)
+    {
+        lo = juce::jmin(lo, (int)bins[b].min);
+        hi = juce::jmax(hi, (int)bins[b].max);
+        squares += (float)bins[b].rms * bins[b].rms;
+        lowSquares += (float)bins[b].low * bins[b].low;
+        midSquares += (float)bins[b].mid * bins[b].mid;
+        highSquares += (float)bins[b].high * bins[b].high;
+    }
+
+    const float scale = 1.0f / (float)(last - first + 1);
+    auto level = [scale](float sum) { return std::sqrt(sum * scale) / 255.0f; };
+
+    return { (float)lo / 127.0f, (float)hi / 127.0f,
+             level(squares), level(lowSquares), level(midSquares), level(highSquares) };
+}
+
+//==============================================================================
+WaveformCache::WaveformCache(juce::AudioFormatManager& fm)
+    : formatManager(fm),
+      folder(juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                 .getChildFile(juce::String(ProjectInfo::projectName)).getChildFile("WaveformCache"))
+{
+}
+
+WaveformCache::~WaveformCache()
+{
+    // lookups hand misses to the builder, which waits on its chunks, so in that order
+    cancelled.store(true);
+    lookupPool.removeAllJobs(true, -1);
+    buildPool.removeAllJobs(true, -1);
+    chunkPool.removeAllJobs(true, -1);
+}
+
+void WaveformCache::request(const juce::File& track, Callback callback)
+{
+    lookupPool.addJob([this, track, callback = std::move(callback)]
+        {
+            auto pyramid = findCached(track);
+
+            if (pyramid == nullptr && track.existsAsFile())
+            {
+                // new or changed since, hashed in full and built behind any other build
+                buildPool.addJob([this, track, callback]
+                    {
+                        auto built = findOrBuild(track);
+                        juce::MessageManager::callAsync([callback, built] { callback(built); });
+                    });
+                return;
+            }
+
+            juce::MessageManager::callAsync([callback, pyramid] { callback(pyramid); });
+        });
+}
+
+juce::String WaveformCache::getContentKey(const juce::String& quickKey)
+{
+    const juce::ScopedLock sl(lock);
+
+    auto& key = contentKeys[quickKey];
+    if (key.isEmpty())
+        key = folder.getChildFile(quickKey + ".key").loadFileAsString().trim();
+
+    return key;
+}
+
+std::shared_ptr<const WaveformPyramid> WaveformCache::openShared(const juce::String& contentKey)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        if (auto shared = live[contentKey].lock())
+            return shared;
+    }
+
+    std::shared_ptr<const WaveformPyramid> pyramid = WaveformPyramid::open(folder.getChildFile(contentKey + ".waveform"));
+
+    if (pyramid != nullptr)
+    {
+        const juce::ScopedLock sl(lock);
+        live[contentKey] = pyramid;
+    }
+
+    return pyramid;
+}
+
+std::shared_ptr<const WaveformPyramid> WaveformCache::findCached(const juce::File& track)
+{
+    const auto quickKey = getQuickKey(track);
+    if (quickKey.isEmpty()) return nullptr;
+
+    const auto contentKey = getContentKey(quickKey);
+    return contentKey.isNotEmpty() ? openShared(contentKey) : nullptr;
+}
+
+std::shared_ptr<const WaveformPyramid> WaveformCache::findOrBuild(const juce::File& track)
+{
+    // an earlier build may have made it since the lookup
+    if (auto pyramid = findCached(track))
+        return pyramid;
+
+    const auto quickKey = getQuickKey(track);
+    if (quickKey.isEmpty()) return nullptr;
+
+    // same audio under another name or folder finds the same sidecar
+    const auto contentKey = juce::MD5(track).toHexString();
+
+    std::shared_ptr<const WaveformPyramid> pyramid = openShared(contentKey);
+
+    if (pyramid == nullptr)
+    {
+        pyramid = WaveformPyramid::build(formatManager, track, folder.getChildFile(contentKey + ".waveform"), chunkPool, cancelled);
+        if (pyramid == nullptr) return nullptr;
+
+        const juce::ScopedLock sl(lock);
+        live[contentKey] = pyramid;
+    }
+
+    // next time this file is found from its quick key alone
+    {
+        const juce::ScopedLock sl(lock);
+        contentKeys[quickKey] = contentKey;
+    }
+
+    if (folder.createDirectory())
+        folder.getChildFile(quickKey + ".key").replaceWithText(contentKey);
+
+    return pyramid;
+}
@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    WaveformPyramid.h
+    Created: 18 Oct 2026 4:12:37am
+    Author:  Lena
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <juce_dsp/juce_dsp.h>
+
+// https://docs.juce.com/master/classMemoryMappedFile.html <-- documentation used
+
+// min / max / rms and low / mid / high energy of a track at every zoom,
+// from a few samples per bin up to the whole track
+// level 0 is baseSamplesPerBin samples per bin, each level above halves the one below
+// stored as a sidecar file that is memory mapped as is, so reopening a track costs no decoding
+class WaveformPyramid
+{
+public:
+    // one byte each: min / max -127..127, rms and band rms 0..255
+    struct Bin
+    {
+        juce::int8 min;
+        juce::int8 max;
+        juce::uint8 rms;
+
+        // energy below lowCrossover, between the two, above highCrossover
+        juce::uint8 low;
+        juce::uint8 mid;
+        juce::uint8 high;
+    };
+
+    static constexpr int baseSamplesPerBin = 64;
+
+    // band edges in Hz, 4th order Linkwitz-Riley
+    static constexpr double lowCrossover = 200.0;
+    static constexpr double highCrossover = 2000.0;
+
+    // levels stop once one fits in this many bins
+    static constexpr int maxTopBins = 256;
+
+    // maps a sidecar written by build, nullptr if it is missing or doesn't check out
+    static std::unique_ptr<WaveformPyramid> open(const juce::File& sidecar);
+
+    // decodes the track in parallel chunks on pool and saves the sidecar (best effort)
+    // nullptr if the track can't be read or cancelled was set
+    static std::unique_ptr<WaveformPyramid> build(juce::AudioFormatManager& formatManager,
+                                                  const juce::File& track,
+                                                  const juce::File& sidecar,
+                                                  juce::ThreadPool& pool,
+                                                  const std::atomic<bool>& cancelled);
+
+    double getSampleRate() const { return sampleRate; }
+    juce::int64 getLengthInSamples() const { return length; }
+
+    int getNumLevels() const { return (int)levels.size(); }
+    int getSamplesPerBin(int level) const { return baseSamplesPerBin << level; }
+    juce::int64 getNumBins(int level) const { return levels[(size_t)level].numBins; }
+    const Bin* getBins(int level) const { return levels[(size_t)level].bins; }
+
+    // -1..1 / 0..1
+    struct Range
+    {
+        float min{ 0.0f };
+        float max{ 0.0f };
+        float rms{ 0.0f };
+        float low{ 0.0f };
+        float mid{ 0.0f };
+        float high{ 0.0f };
+    };
+
+    // envelope of [startSample, endSample), read from the coarsest level that still resolves it
+    Range getRange(juce::int64 startSample, juce::int64 endSample) const;
+
+private:
+    WaveformPyramid() = default;
+
+    // reads the header and points the levels into data, false if anything is off
+    bool parse();
+
+    struct Level
+    {
+        const Bin* bins{ nullptr };
+        juce::int64 numBins{ 0 };
+    };
+
+    // whichever holds the file image: the mapping, or the freshly built copy
+    std::unique_ptr<juce::MemoryMappedFile> mapped;
+    juce::MemoryBlock owned;
+    const char* data{ nullptr };
+    size_t size{ 0 };
+
+    double sampleRate{ 0.0 };
+    juce::int64 length{ 0 };
+    std::vector<Level> levels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformPyramid)
+};
+
+// finds or builds the pyramid for a track, keyed by a hash of its contents
+// sidecars live in the app data folder, tracks open on more than one deck share one mapping
+// a track seen before is found from its size, modification time and a hash of its ends,
+// only new or changed files are hashed in full
+class WaveformCache
+{
+public:
+    explicit WaveformCache(juce::AudioFormatManager& formatManager);
+    ~WaveformCache();
+
+    using Callback = std::function<void(std::shared_ptr<const WaveformPyramid>)>;
+
+    // callback runs on the message thread, with nullptr if the track can't be read
+    void request(const juce::File& track, Callback callback);
+
+private:
+    // lookup thread: nullptr unless the track was seen before and its sidecar is still there
+    std::shared_ptr<const WaveformPyramid> findCached(const juce::File& track);
+
+    // build thread: full hash, then the sidecar of the same audio or a new build
+    std::shared_ptr<const WaveformPyramid> findOrBuild(const juce::File& track);
+
+    // content hash for a quick key, from memory or its link file, empty if unknown
+    juce::String getContentKey(const juce::String& quickKey);
+
+    // the pyramid already in use or mapped from its sidecar
+    std::shared_ptr<const WaveformPyramid> openShared(const juce::String& contentKey);
+
+    juce::AudioFormatManager& formatManager;
+    const juce::File folder;
+
+    // pyramids still in use by content hash, content hash by quick key
+    juce::CriticalSection lock;
+    std::map<juce::String, std::weak_ptr<const WaveformPyramid>> live;
+    std::map<juce::String, juce::String> contentKeys;
+
+    // set on shutdown, running builds give up
+    std::atomic<bool> cancelled{ false };
+
+    // cached lookups never wait behind a build
+    // one build at a time, split across every other core
+    juce::ThreadPool lookupPool{ 1 };
+    juce::ThreadPool buildPool{ 1 };
+    juce::ThreadPool chunkPool{ juce::jmax(1, juce::SystemStats::getNumCpus() - 1), 0, juce::Thread::Priority::low };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformCache)
+};